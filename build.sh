@@ -2,14 +2,61 @@
 
 set -e
 
+# Usage: ./build.sh [debug|release|relwithdebinfo|profile|pgo]
+#
+#   debug          - no optimization, full debug info (default).
+#   release        - -O3, -march=$MARCH and ThinLTO.
+#   relwithdebinfo - -O2 with debug info.
+#   profile        - -O2 with debug info and frame pointers,
+#                    for `perf` and other sampling profilers.
+#   pgo            - builds an instrumented release, trains it on the
+#                    headless sample runs (needs EGL) and rebuilds
+#                    `release` with the collected profile.
+#
+# Every mode builds into its own `build/<mode>` directory.
+MODE=${1:-debug}
+
+# `native` is only right for the machine that builds it, set
+# `MARCH` (e.g. `x86-64-v3`) for binaries that run elsewhere.
+MARCH=${MARCH:-native}
+
 CXX=clang++
+# ThinLTO objects are LLVM bitcode, GNU ar can't index them.
+AR=llvm-ar
 
 PKGS="glfw3 glew"
-CXXFLAGS="-Wall -Wextra -std=c++20 -pedantic -ggdb $(pkg-config --cflags $PKGS)"
+CXXFLAGS="-Wall -Wextra -std=c++20 -pedantic $(pkg-config --cflags $PKGS)"
 LIBS="$(pkg-config --libs $PKGS)"
 
-BUILDDIR="$(pwd)/build"
-mkdir -p $BUILDDIR
+# Headless contexts (see src/advanced/opengl/context.hpp) are
+# only built in when the libraries are around.
+if pkg-config --exists egl; then
+    CXXFLAGS="$CXXFLAGS -DOPENGL_HAS_EGL $(pkg-config --cflags egl)"
+    LIBS="$LIBS $(pkg-config --libs egl)"
+fi
+
+if pkg-config --exists osmesa; then
+    CXXFLAGS="$CXXFLAGS -DOPENGL_HAS_OSMESA $(pkg-config --cflags osmesa)"
+    LIBS="$LIBS $(pkg-config --libs osmesa)"
+fi
+
+RELEASE_FLAGS="-O3 -DNDEBUG -march=$MARCH -flto=thin -fuse-ld=lld"
+
+function mode_flags() {
+    case $1 in
+        debug)          echo "-O0 -ggdb" ;;
+        release)        echo "$RELEASE_FLAGS" ;;
+        relwithdebinfo) echo "-O2 -ggdb -DNDEBUG" ;;
+        profile)        echo "-O2 -ggdb -DNDEBUG -fno-omit-frame-pointer" ;;
+        *)
+            echo "ERROR: unknown build mode \`$1\`" >&2
+            exit 1
+            ;;
+    esac
+}
+
+# Set to 1 to rebuild everything, even if it's up to date.
+FORCE_REBUILD=${FORCE_REBUILD:-0}
 
 function subdir() {
     local dir=$1
@@ -25,39 +72,229 @@ function subdir() {
     popd
 }
 
-function build() {
-    local files=$@
+# Jobs run in the background, at most `JOBS` at a time. A job that
+# fails leaves a marker behind, checked by `wait_jobs`.
+JOBS=${JOBS:-$(nproc)}
 
-    local main_file=$1
-    local out_file=$(echo $main_file | rev | cut -f 2- -d '.' | rev)
+function job() {
+    while [ "$(jobs -rp | wc -l)" -ge "$JOBS" ]; do
+        wait -n || true
+    done
 
-    echo
-    echo "    > ======================================"
-    echo "    > Building \`$out_file\`"
-    echo "    > ======================================"
-    echo
+    ( "$@" || touch "$BUILDDIR/.failed" ) &
+}
 
-    local needs_rebuild=0
-    
-    for file in $files; do
-        if [ "$file" -nt "$BUILDDIR/$out_file" ]; then
-            needs_rebuild=1
-            break
+function wait_jobs() {
+    wait
+
+    if [ -f "$BUILDDIR/.failed" ]; then
+        rm -f "$BUILDDIR/.failed"
+        echo "ERROR: build failed" >&2
+        exit 1
+    fi
+}
+
+# An object is rebuilt when it's missing, when it was compiled with
+# different flags, or when its source or any header it included
+# (listed by `-MMD` in the `.d` file next to it) is newer.
+function object_outdated() {
+    local source=$1
+    local object=$2
+    local flags=$3
+
+    if [ "$FORCE_REBUILD" -eq 1 ] || [ ! -f "$object" ] || [ "$source" -nt "$object" ]; then
+        return 0
+    fi
+
+    if [ "$(cat "$object.flags" 2> /dev/null)" != "$flags" ] || [ ! -f "${object%.o}.d" ]; then
+        return 0
+    fi
+
+    local dependency
+    for dependency in $(sed -e 's/^[^:]*://' -e 's/\\$//' "${object%.o}.d"); do
+        if [ "$dependency" -nt "$object" ]; then
+            return 0
         fi
     done
 
-    if [ ! -f "$BUILDDIR/$out_file" ]; then
-        needs_rebuild=1
+    return 1
+}
+
+function compile() {
+    local source=$1
+    local object=$2
+    local flags=$3
+
+    if ! object_outdated "$source" "$object" "$flags"; then
+        return 0
+    fi
+
+    echo "    > Compiling \`$source\`"
+
+    mkdir -p "$(dirname "$object")"
+
+    # `set -e` doesn't apply here (jobs run under `||`), failures must
+    # be returned. The old object goes, so it isn't archived or linked.
+    if ! $CXX $flags -MMD -MP -c -o "$object" "$source"; then
+        rm -f "$object" "$object.flags"
+        return 1
     fi
 
-    if [ "$needs_rebuild" -eq 1 ]; then
-        $CXX $CXXFLAGS -o $BUILDDIR/$out_file $files $LIBS
+    echo "$flags" > "$object.flags"
+    echo compiled >> "$BUILDDIR/.stats"
+}
+
+function link() {
+    local out_file=$1
+    shift
+    local inputs=$@
+
+    local input
+    local needs_link=$FORCE_REBUILD
+    for input in $inputs; do
+        if [ "$input" -nt "$BUILDDIR/$out_file" ]; then
+            needs_link=1
+        fi
+    done
+
+    if [ ! -f "$BUILDDIR/$out_file" ] || [ "$needs_link" -eq 1 ]; then
+        echo "    > Linking \`$out_file\`"
+        $CXX $CXXFLAGS -o "$BUILDDIR/$out_file" $inputs $LIBS || return 1
+        echo linked >> "$BUILDDIR/.stats"
     fi
 }
 
-function build_parallel() {
-    build $1 &
-    sleep 0.001
+# Compiles `sources` (in parallel) into `$BUILDDIR/lib<name>.a`, and
+# waits for it, so it's ready to be linked by the executables after it.
+function library() {
+    local name=$1
+    local extra_flags=$2
+    shift 2
+    local sources=$@
+
+    local objects=""
+    local source
+    for source in $sources; do
+        local object="$BUILDDIR/obj/lib$name/$(basename ${source%.*}).o"
+        objects="$objects $object"
+        job compile "$source" "$object" "$CXXFLAGS $extra_flags"
+    done
+
+    wait_jobs
+
+    local archive="$BUILDDIR/lib$name.a"
+    local object
+    for object in $objects; do
+        if [ "$object" -nt "$archive" ] || [ ! -f "$archive" ]; then
+            echo "    > Archiving \`lib$name.a\`"
+            rm -f "$archive"
+            $AR rcs "$archive" $objects
+            break
+        fi
+    done
+}
+
+function library_path() {
+    echo "$BUILDDIR/lib$1.a"
 }
 
-subdir src
\ No newline at end of file
+function build_executable() {
+    local out_file=$1
+    local extra_flags=$2
+    shift 2
+
+    local inputs=""
+    local file
+    for file in $@; do
+        if [[ "$file" == *.a ]]; then
+            inputs="$inputs $file"
+        else
+            local object="$BUILDDIR/obj/$out_file/$(basename ${file%.*}).o"
+            compile "$file" "$object" "$CXXFLAGS $extra_flags" || return 1
+            inputs="$inputs $object"
+        fi
+    done
+
+    link "$out_file" $inputs
+}
+
+# `files` are sources, compiled with `extra_flags`, and libraries
+# (see `library_path`). Runs as a job, call `wait_jobs` to finish it.
+function build_variant() {
+    local out_file=$1
+    local extra_flags=$2
+    shift 2
+
+    job build_executable "$out_file" "$extra_flags" $@
+}
+
+function build() {
+    local files=$@
+
+    local main_file=$1
+    local out_file=$(echo $main_file | rev | cut -f 2- -d '.' | rev)
+
+    build_variant "$out_file" "" $files
+}
+
+function build_mode() {
+    local mode=$1
+    local extra_flags=$2
+
+    BUILDDIR="$(pwd)/build/$mode"
+    mkdir -p $BUILDDIR
+
+    local saved_flags=$CXXFLAGS
+    CXXFLAGS="$CXXFLAGS $(mode_flags ${mode%-*}) $extra_flags"
+
+    rm -f "$BUILDDIR/.stats" "$BUILDDIR/.failed"
+    local start=$(date +%s.%N)
+
+    subdir src
+    wait_jobs
+
+    local end=$(date +%s.%N)
+    local compiled=$(grep -c compiled "$BUILDDIR/.stats" 2> /dev/null || true)
+    local linked=$(grep -c linked "$BUILDDIR/.stats" 2> /dev/null || true)
+
+    echo
+    echo "INFO: \`$mode\`: compiled ${compiled:-0} objects and linked ${linked:-0}" \
+         "executables in $(awk "BEGIN { print $end - $start }") s"
+
+    CXXFLAGS=$saved_flags
+}
+
+# Runs the instrumented binaries on the kind of work the samples and
+# benchmarks do, without a display.
+function pgo_train() {
+    local bin=$1
+
+    $bin/abstraction_sample --headless --frames 2000
+    $bin/uniform_buffer_sample --headless --frames 2000
+    $bin/bench_batching --headless 50 10000
+    $bin/bench_streaming --headless 100 30000
+    $bin/bench_state_cache --headless 50 1000
+    $bin/bench_shader_parse 4 3
+}
+
+if [ "$MODE" = "pgo" ]; then
+    if ! pkg-config --exists egl; then
+        echo "ERROR: PGO trains on headless runs, which need EGL" >&2
+        exit 1
+    fi
+
+    PGO_DIR="$(pwd)/build/pgo"
+    rm -rf $PGO_DIR/raw
+    mkdir -p $PGO_DIR/raw
+
+    build_mode release-instrumented "-fprofile-generate=$PGO_DIR/raw"
+    pgo_train build/release-instrumented
+
+    llvm-profdata merge -output=$PGO_DIR/merged.profdata $PGO_DIR/raw/*.profraw
+
+    FORCE_REBUILD=1
+    build_mode release "-fprofile-use=$PGO_DIR/merged.profdata"
+else
+    mode_flags $MODE > /dev/null
+    build_mode $MODE ""
+fi
\ No newline at end of file
@@ -0,0 +1,22 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+
+void main()
+{
+   gl_Position = position;
+}
+
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+uniform vec4 u_Colors[4];
+
+void main()
+{
+   color = u_Colors[0] + u_Colors[1] + u_Colors[2] + u_Colors[3];
+}
\ No newline at end of file
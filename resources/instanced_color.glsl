@@ -0,0 +1,31 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+
+// Per-instance attributes (divisor = 1).
+layout(location = 1) in vec2 offset;
+layout(location = 2) in vec4 color;
+
+uniform float u_Scale;
+
+out vec4 vertexColor;
+
+void main()
+{
+   gl_Position = vec4(position.xy * u_Scale + offset, 0.0, 1.0);
+   vertexColor = color;
+}
+
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 vertexColor;
+
+void main()
+{
+   color = vertexColor;
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+
+uniform float u_Scale;
+uniform vec2 u_Offset;
+
+void main()
+{
+   gl_Position = vec4(position.xy * u_Scale + u_Offset, 0.0, 1.0);
+}
+
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+uniform vec4 u_Color;
+
+void main()
+{
+   color = u_Color;
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#shader vertex
+#version 330 core
+
+// Positions quantized to the bounds of the mesh, see
+// `VertexEncoding::Snorm16` in vertex_encoding.hpp.
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec4 color;
+
+uniform vec2 u_PositionScale;
+uniform vec2 u_PositionOffset;
+
+out vec4 vertexColor;
+
+void main()
+{
+   gl_Position = vec4(position * u_PositionScale + u_PositionOffset, 0.0, 1.0);
+   vertexColor = color;
+}
+
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 vertexColor;
+
+void main()
+{
+   color = vertexColor;
+}
\ No newline at end of file
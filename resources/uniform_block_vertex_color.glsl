@@ -0,0 +1,34 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec4 color;
+
+// Parameters shared by every shader that uses this block.
+// Must match the `UniformBlockLayout` in the main program.
+layout(std140) uniform Frame {
+    vec4 u_Tint;
+    vec2 u_Offset;
+    float u_Time;
+};
+
+out vec4 vertexColor;
+
+void main()
+{
+   gl_Position = position - vec4(u_Offset, 0.0, 0.0);
+   vertexColor = color * (0.5 + 0.5 * sin(u_Time));
+}
+
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 vertexColor;
+
+void main()
+{
+   color = vertexColor;
+}
\ No newline at end of file
@@ -3,30 +3,31 @@
 #include <string>
 
 #include <GL/glew.h>
-#include <GLFW/glfw3.h>
 
+#include "opengl/context.hpp"
 #include "opengl/errors.hpp"
 #include "opengl/vertex_array.hpp"
 #include "opengl/shader.hpp"
+#include "opengl/shader_watcher.hpp"
+#include "opengl/profiler.hpp"
 
-int main()
+// Pass `--headless` (or `--headless=osmesa`) to render without a
+// display and `--frames N` to stop after N frames. A path after
+// that gets a Chrome trace of the run.
+int main(int argc, char** argv)
 {
-    if (!glfwInit())
-        return -1;
-
-    GLFWwindow* window = glfwCreateWindow(640, 480, "Hello World", 
-                                          nullptr, nullptr);
-    if (!window) {
-        glfwTerminate();
-        return -1;
-    }
+    ContextSettings settings = context_settings_from_args(argc, argv);
+    settings.title = "Hello World";
 
-    glfwMakeContextCurrent(window);
-    
-    if (glewInit() != GLEW_OK) {
-        std::cerr << "ERROR: could not initialize GLEW" << std::endl;
+    Context context(settings);
+    if (!context.valid)
         return 1;
-    }
+
+    gl_init_errors();
+
+    profiler().enable();
+    if (argc > 1)
+        profiler().enable_trace(argv[1]);
 
     float vertexes[] = {
         // x    y
@@ -39,50 +40,70 @@ int main()
         0, 1, 2
     };
 
-    VertexArray* va = new VertexArray();
+    VertexArray va;
 
-    va->bind();
+    va.bind();
 
-    VertexBuffer* vb = va->bind_vertex_buffer(vertexes, sizeof(vertexes));
-    vb->set_attribute_layout(0, 2, GL_FLOAT, GL_FALSE, sizeof(vertexes[0]) * 2, 0);
+    VertexBuffer* vb = va.bind_vertex_buffer(vertexes, sizeof(vertexes));
+    vb->set_layout<VertexLayout<Attr<float, 2>>>();
 
-    IndexBuffer* ib = va->bind_index_buffer(indices, sizeof(indices) / sizeof(indices[0]));
+    IndexBuffer* ib = va.bind_index_buffer(indices, sizeof(indices) / sizeof(indices[0]));
     (void)ib;
 
-    va->unbind_all();
+    va.unbind_all();
 
-    Shader* shader = new Shader("resources/default_fragment_color.glsl");
+    Shader shader("resources/default_fragment_color.glsl");
 
-    shader->bind();
-    shader->set_uniform_4f("u_Color", 1, 0, 0, 1);
-    shader->unbind();
+    UniformHandle u_color = shader.get_uniform("u_Color");
+
+    // Edit the shader while this runs to see it reloaded.
+    shader.watch();
+
+    shader.bind();
+    shader.set_uniform_4f(u_color, 1, 0, 0, 1);
+    shader.unbind();
 
     float r = 0;
     float r_increment = 0.01;
 
-    while (!glfwWindowShouldClose(window)) {
-        gl(Clear, GL_COLOR_BUFFER_BIT);
+    while (!context.should_close()) {
+        profiler().begin_frame();
+
+        shader_watcher().update();
 
-        shader->bind();
-        shader->set_uniform_4f("u_Color", r, 0.3, 0.8, 1);
+        {
+            PROFILE_SCOPE("draw");
+            PROFILE_GPU_SCOPE("draw");
 
-        va->bind();
-        gl(DrawElements, GL_TRIANGLES, 3, GL_UNSIGNED_INT, nullptr);
-        va->unbind();
+            gl(Clear, GL_COLOR_BUFFER_BIT);
 
-        shader->unbind();
+            shader.bind();
+            shader.set_uniform_4f(u_color, r, 0.3, 0.8, 1);
+
+            va.bind();
+            va.draw_elements(3);
+            va.unbind();
+
+            shader.unbind();
+        }
 
         if (r > 1.0f || r < 0)
             r_increment *= -1;
         r += r_increment;
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        gl_frame_check_errors();
+
+        context.swap_buffers();
+        context.poll_events();
+
+        profiler().end_frame();
     }
 
-    delete shader;
-    delete va;
-    glfwTerminate();
-    
+    context.report_frame_times();
+
+    if (argc > 1)
+        profiler().write_trace();
+    profiler().disable();
+
     return 0;
 }
\ No newline at end of file
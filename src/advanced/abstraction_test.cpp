@@ -3,31 +3,20 @@
 #include <string>
 
 #include <GL/glew.h>
-#include <GLFW/glfw3.h>
 
+#include "opengl/context.hpp"
 #include "opengl/vertex_array.hpp"
 #include "opengl/shader.hpp"
+#include "opengl/state_cache.hpp"
+#include "opengl/profiler.hpp"
 
-int main()
+int main(int argc, char** argv)
 {
-    if (!glfwInit()) {
-        std::cerr << "ERROR: could not initialize GLFW" << std::endl;
+    // Creates a window (or a headless context with `--headless`),
+    // makes its OpenGL context current and initializes GLEW.
+    Context context(context_settings_from_args(argc, argv));
+    if (!context.valid)
         return 1;
-    }
-
-    GLFWwindow* window = glfwCreateWindow(640, 480, "OpenGL Application",
-                                          nullptr, nullptr);
-    if (!window) {
-        std::cerr << "ERROR: could not create GLFW window" << std::endl;
-        return 1;
-    }
-
-    glfwMakeContextCurrent(window);
-
-    if (glewInit() != GLEW_OK) {
-        std::cerr << "ERROR: could not initialize GLEW" << std::endl;
-        return 1;
-    }
 
     std::cout << "INFO: OpenGL initialized successfully" << std::endl;
     std::cout << " > OpenGL version: " << glGetString(GL_VERSION) << std::endl;
@@ -40,8 +29,8 @@ int main()
     // VAOs store the configuration and layouts of vertex buffers.
     // This is useful because, if we bind the VAO, we don't need to
     // specify the layout of the vertex buffers again.
-    VertexArray* va = new VertexArray();
-    va->bind();
+    VertexArray va;
+    va.bind();
 
     // Define the positions of the points in the triangle.
     // This is an array of vertexes (or simply, the vertex buffer).
@@ -61,11 +50,10 @@ int main()
         0, 1, 2,
     };
 
-    VertexBuffer* vb = va->bind_vertex_buffer(vertexes_with_positions, 
+    VertexBuffer* vb = va.bind_vertex_buffer(vertexes_with_positions, 
                                               sizeof(vertexes_with_positions));
-    IndexBuffer* ib = va->bind_index_buffer(vertex_indices, 
+    IndexBuffer* ib = va.bind_index_buffer(vertex_indices, 
                                             sizeof(vertex_indices) / sizeof(vertex_indices[0]));
-    (void)ib;
 
     /*                                       *
      *   -=-= Layout the data in VRAM =-=-   *
@@ -105,7 +93,7 @@ int main()
                              sizeof(vertexes_with_positions[0]) * 2);
 
     // Unbind vertex array.
-    va->unbind_all();
+    va.unbind_all();
 
     /*                            *
      *   -=-= Shader setup =-=-   *
@@ -121,8 +109,8 @@ int main()
     // so we'll just set `gl_Position` to the provided position.
     // See ./resources/default_vertex_color.glsl
 
-    Shader* shader = new Shader("resources/default_vertex_color.glsl");
-    if (!shader->valid) {
+    Shader shader("resources/default_vertex_color.glsl");
+    if (!shader.valid) {
         return 1;
     }
 
@@ -130,15 +118,20 @@ int main()
      *   -=-= Main loop =-=-   *
      *                         */
     
-    while (!glfwWindowShouldClose(window)) {
+    // Prints timings and counters every 120 frames.
+    profiler().enable();
+
+    while (!context.should_close()) {
+        profiler().begin_frame();
+
         glClearColor(0.7f, 0.7f, 0.7f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
         // Use the shader we created previously.
-        shader->bind();
+        shader.bind();
 
         // Bind the VAO before drawing.
-        va->bind();
+        va.bind();
 
         // Draw the vertexes in the element (index) array buffer
         // (In this case, the triangle index buffer. Because the triangle
@@ -149,21 +142,30 @@ int main()
                        // Number of elements to be rendered.
                        sizeof(vertex_indices) / sizeof(vertex_indices[0]),
                        
-                       // Type of the indices.
-                       GL_UNSIGNED_INT,
+                       // Type of the indices. The index buffer stores them
+                       // in the smallest type that fits (bytes, here).
+                       ib->get_type(),
 
                        // Offset of the first index in the array.
                        (const void*)0);
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        context.swap_buffers();
+        context.poll_events();
+
+        profiler().end_frame();
     }
 
-    // Cleanup: Delete VAO, VBO, IBO, shader program, and GLFW resources.
-    delete va;
-    delete shader;
-    glfwDestroyWindow(window);
-    glfwTerminate();
+    profiler().disable();
+
+    // Binding something that's already bound is skipped.
+    // In this loop, everything after the first frame is skipped.
+    const GLStateStats& stats = gl_state().get_stats();
+    std::cout << "INFO: state changes: " << stats.issued << " issued, "
+              << stats.skipped << " skipped" << std::endl;
+
+    context.report_frame_times();
 
+    // No cleanup: the VAO, VBO, IBO and shader program are deleted
+    // when they go out of scope, then the context (it was created first).
     return 0;
 }
\ No newline at end of file
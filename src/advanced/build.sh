@@ -1,5 +1,9 @@
 # This file is meant to be run with the `subdir` command
 # of the project's root folder's ./build.sh.
 
-build abstraction_test.cpp opengl/*.cpp
-build abstraction_sample.cpp opengl/*.cpp
\ No newline at end of file
+library opengl "" opengl/*.cpp
+
+build abstraction_test.cpp $(library_path opengl)
+build abstraction_sample.cpp $(library_path opengl)
+build uniform_buffer_sample.cpp $(library_path opengl)
+build mesh_convert.cpp $(library_path opengl)
\ No newline at end of file
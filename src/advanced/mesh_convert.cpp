@@ -0,0 +1,40 @@
+#include <iostream>
+#include <string>
+
+#include "opengl/mesh.hpp"
+#include "opengl/mesh_optimizer.hpp"
+
+// Converts a Wavefront OBJ file to the binary `.mesh` format (see
+// `opengl/mesh.hpp`), reordered for the vertex cache on the way.
+// Doesn't need an OpenGL context.
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <input.obj> <output.mesh>" << std::endl;
+        return 1;
+    }
+
+    MeshData mesh;
+    if (!load_obj(argv[1], mesh))
+        return 1;
+
+    report_vertex_cache("before", mesh.indices.data(), mesh.indices.size(),
+                        mesh.vertex_count);
+
+    optimize_vertex_cache(mesh.indices.data(), mesh.indices.size(), mesh.vertex_count);
+    mesh.vertex_count = optimize_vertex_fetch(mesh.indices.data(), mesh.indices.size(),
+                                              mesh.vertices.data(), mesh.vertex_count,
+                                              mesh.stride);
+    mesh.vertices.resize(mesh.vertex_count * mesh.stride);
+
+    report_vertex_cache("after", mesh.indices.data(), mesh.indices.size(),
+                        mesh.vertex_count);
+
+    if (!save_mesh(argv[2], mesh))
+        return 1;
+
+    std::cout << "INFO: wrote " << mesh.indices.size() / 3 << " triangles and "
+              << mesh.vertex_count << " vertices to `" << argv[2] << "`" << std::endl;
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "batch_renderer.hpp"
+
+#include "errors.hpp"
+#include "vertex_layout.hpp"
+
+using BatchVertexLayout = VertexLayout<Attr<float, 2>, Attr<float, 4>>;
+VERTEX_LAYOUT_CHECK(BatchVertexLayout, BatchVertex, x, r);
+
+BatchRenderer::BatchRenderer(std::size_t max_quads)
+    : m_max_quads(max_quads), m_stats()
+{
+    m_vertices.reserve(m_max_quads * 4);
+
+    // Every batch uses the same indices, so they're generated once
+    // for the biggest batch possible.
+    std::vector<unsigned int> indices(m_max_quads * 6);
+    for (std::size_t i = 0; i < m_max_quads; ++i) {
+        unsigned int base = i * 4;
+
+        indices[i * 6 + 0] = base + 0;
+        indices[i * 6 + 1] = base + 1;
+        indices[i * 6 + 2] = base + 2;
+        indices[i * 6 + 3] = base + 2;
+        indices[i * 6 + 4] = base + 3;
+        indices[i * 6 + 5] = base + 0;
+    }
+
+    m_va.bind();
+
+    m_vb = m_va.bind_vertex_buffer(nullptr, m_max_quads * 4 * sizeof(BatchVertex),
+                                   GL_DYNAMIC_DRAW);
+    m_vb->set_layout<BatchVertexLayout>();
+
+    m_ib = m_va.bind_index_buffer(indices.data(), indices.size());
+
+    m_va.unbind_all();
+}
+
+void BatchRenderer::begin_frame()
+{
+    m_stats = {};
+}
+
+void BatchRenderer::end_frame()
+{
+    flush();
+}
+
+void BatchRenderer::flush()
+{
+    if (m_vertices.empty())
+        return;
+
+    std::size_t quads = m_vertices.size() / 4;
+
+    m_va.bind();
+    m_vb->bind();
+    m_vb->set_data(m_vertices.data(), m_vertices.size() * sizeof(BatchVertex));
+
+    m_va.draw_elements(quads * 6);
+
+    m_va.unbind();
+
+    m_stats.draw_calls++;
+    m_stats.vertices += m_vertices.size();
+
+    m_vertices.clear();
+}
+
+void BatchRenderer::submit_triangle(const BatchVertex& a, const BatchVertex& b, 
+                                    const BatchVertex& c)
+{
+    // Triangles go through the quad indices as a quad whose
+    // second triangle is degenerate (c, c, a).
+    submit_quad(a, b, c, c);
+}
+
+void BatchRenderer::submit_quad(const BatchVertex& a, const BatchVertex& b, 
+                                const BatchVertex& c, const BatchVertex& d)
+{
+    if (m_vertices.size() + 4 > m_max_quads * 4)
+        flush();
+
+    m_vertices.push_back(a);
+    m_vertices.push_back(b);
+    m_vertices.push_back(c);
+    m_vertices.push_back(d);
+}
+
+void BatchRenderer::submit_quad(float x, float y, float width, float height,
+                                float r, float g, float b, float a)
+{
+    submit_quad({ x, y, r, g, b, a },
+                { x + width, y, r, g, b, a },
+                { x + width, y + height, r, g, b, a },
+                { x, y + height, r, g, b, a });
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+#include <cstddef>
+
+#include "vertex_array.hpp"
+
+// Vertex layout expected by the shader bound while flushing
+// (e.g. resources/default_vertex_color.glsl).
+struct BatchVertex {
+    float x, y;
+    float r, g, b, a;
+};
+
+struct BatchStats {
+    std::size_t draw_calls;
+    std::size_t vertices;
+};
+
+// Accumulates triangles and quads on the CPU and draws them
+// with as few `glDrawElements` as possible.
+// The shader must be bound by the caller before anything is flushed.
+class BatchRenderer {
+private:
+    VertexArray m_va;
+    VertexBuffer* m_vb;
+    IndexBuffer* m_ib;
+
+    std::size_t m_max_quads;
+    std::vector<BatchVertex> m_vertices;
+
+    BatchStats m_stats;
+
+public:
+    BatchRenderer(std::size_t max_quads = 10000);
+
+    // Resets the statistics.
+    void begin_frame();
+    // Draws whatever is still pending.
+    void end_frame();
+
+    void flush();
+
+    void submit_triangle(const BatchVertex& a, const BatchVertex& b, const BatchVertex& c);
+    // Vertices in counter-clockwise order.
+    void submit_quad(const BatchVertex& a, const BatchVertex& b, 
+                     const BatchVertex& c, const BatchVertex& d);
+    void submit_quad(float x, float y, float width, float height,
+                     float r, float g, float b, float a);
+
+    inline const BatchStats& get_stats() const { return m_stats; }
+};
\ No newline at end of file
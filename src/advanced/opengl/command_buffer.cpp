@@ -0,0 +1,47 @@
+#include "command_buffer.hpp"
+
+#include "errors.hpp"
+
+void CommandBuffer::execute() const
+{
+    for (const RenderCommand& command : m_commands) {
+        switch (command.type) {
+        case RenderCommandType::ClearColor:
+            gl(ClearColor, command.values[0], command.values[1],
+                           command.values[2], command.values[3]);
+            break;
+        case RenderCommandType::Clear:
+            gl(Clear, command.mode);
+            break;
+        case RenderCommandType::BindShader:
+            command.shader->bind();
+            break;
+        case RenderCommandType::SetUniform1f:
+            command.shader->set_uniform_1f(command.uniform, command.values[0]);
+            break;
+        case RenderCommandType::SetUniform2f:
+            command.shader->set_uniform_2f(command.uniform, command.values[0],
+                                           command.values[1]);
+            break;
+        case RenderCommandType::SetUniform4f:
+            command.shader->set_uniform_4f(command.uniform,
+                                           command.values[0], command.values[1],
+                                           command.values[2], command.values[3]);
+            break;
+        case RenderCommandType::BindVertexArray:
+            command.vertex_array->bind();
+            break;
+        case RenderCommandType::DrawElements:
+            command.vertex_array->draw_elements(command.count, command.mode);
+            break;
+        case RenderCommandType::DrawInstanced:
+            command.vertex_array->draw_instanced(command.count, command.instances,
+                                                 command.mode);
+            break;
+        case RenderCommandType::DrawElementsInstanced:
+            command.vertex_array->draw_elements_instanced(command.count, command.instances,
+                                                          command.mode);
+            break;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+
+#include "shader.hpp"
+#include "vertex_array.hpp"
+
+enum class RenderCommandType {
+    Clear,
+    ClearColor,
+    BindShader,
+    SetUniform1f,
+    SetUniform2f,
+    SetUniform4f,
+    BindVertexArray,
+    DrawElements,
+    DrawInstanced,
+    DrawElementsInstanced,
+};
+
+// Everything a command needs is copied in, so it can be executed
+// later on another thread. Fields a command doesn't use are left alone.
+struct RenderCommand {
+    RenderCommandType type;
+    // The draw mode, or the mask of `Clear`.
+    GLenum mode;
+    std::uint32_t count;
+    std::uint32_t instances;
+    UniformHandle uniform;
+    float values[4];
+
+    union {
+        Shader* shader;
+        const VertexArray* vertex_array;
+    };
+};
+
+// Records `Shader` and `VertexArray` operations to execute them later,
+// possibly on another thread (see `RenderThread`). Nothing is allocated
+// once the buffer has grown to the size of a frame, `clear` keeps the
+// memory. The shaders and vertex arrays must stay alive until the
+// buffer was executed, and uniform handles must be gotten beforehand:
+// with a `RenderThread`, before it's constructed, since it reloads
+// shaders (and resolves their handles again) while it runs.
+class CommandBuffer {
+private:
+    std::vector<RenderCommand> m_commands;
+
+    inline RenderCommand& add(RenderCommandType type)
+    {
+        RenderCommand& command = m_commands.emplace_back();
+        command.type = type;
+        return command;
+    }
+
+    inline void add_uniform(RenderCommandType type, Shader& shader, UniformHandle uniform,
+                            float x, float y, float z, float w)
+    {
+        RenderCommand& command = add(type);
+        command.shader = &shader;
+        command.uniform = uniform;
+        command.values[0] = x;
+        command.values[1] = y;
+        command.values[2] = z;
+        command.values[3] = w;
+    }
+
+    inline void add_draw(RenderCommandType type, const VertexArray& va, std::size_t count,
+                         std::size_t instances, GLenum mode)
+    {
+        assert(count <= UINT32_MAX && instances <= UINT32_MAX);
+
+        RenderCommand& command = add(type);
+        command.vertex_array = &va;
+        command.mode = mode;
+        command.count = count;
+        command.instances = instances;
+    }
+
+public:
+    inline void clear_color(float r, float g, float b, float a)
+    {
+        RenderCommand& command = add(RenderCommandType::ClearColor);
+        command.values[0] = r;
+        command.values[1] = g;
+        command.values[2] = b;
+        command.values[3] = a;
+    }
+
+    inline void clear(GLbitfield mask)
+    {
+        add(RenderCommandType::Clear).mode = mask;
+    }
+
+    inline void bind_shader(Shader& shader)
+    {
+        add(RenderCommandType::BindShader).shader = &shader;
+    }
+
+    // The shader must be bound when this is executed, like
+    // when calling `Shader::set_uniform_*` directly.
+    inline void set_uniform_1f(Shader& shader, UniformHandle uniform, float x)
+    {
+        add_uniform(RenderCommandType::SetUniform1f, shader, uniform, x, 0, 0, 0);
+    }
+
+    inline void set_uniform_2f(Shader& shader, UniformHandle uniform, float x, float y)
+    {
+        add_uniform(RenderCommandType::SetUniform2f, shader, uniform, x, y, 0, 0);
+    }
+
+    inline void set_uniform_4f(Shader& shader, UniformHandle uniform,
+                               float x, float y, float z, float w)
+    {
+        add_uniform(RenderCommandType::SetUniform4f, shader, uniform, x, y, z, w);
+    }
+
+    inline void bind_vertex_array(const VertexArray& va)
+    {
+        add(RenderCommandType::BindVertexArray).vertex_array = &va;
+    }
+
+    // The vertex array must be bound when these are executed.
+    inline void draw_elements(const VertexArray& va, std::size_t count,
+                              GLenum mode = GL_TRIANGLES)
+    {
+        add_draw(RenderCommandType::DrawElements, va, count, 1, mode);
+    }
+
+    inline void draw_instanced(const VertexArray& va, std::size_t count, std::size_t instances,
+                               GLenum mode = GL_TRIANGLES)
+    {
+        add_draw(RenderCommandType::DrawInstanced, va, count, instances, mode);
+    }
+
+    inline void draw_elements_instanced(const VertexArray& va, std::size_t count,
+                                        std::size_t instances, GLenum mode = GL_TRIANGLES)
+    {
+        add_draw(RenderCommandType::DrawElementsInstanced, va, count, instances, mode);
+    }
+
+    // Runs every command in order, on the thread the context is current on.
+    void execute() const;
+
+    // Forgets the commands, keeping the memory for the next frame.
+    inline void reset() { m_commands.clear(); }
+
+    inline std::size_t get_size() const { return m_commands.size(); }
+};
\ No newline at end of file
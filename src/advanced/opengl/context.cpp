@@ -0,0 +1,469 @@
+#include "context.hpp"
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+
+#ifdef OPENGL_HAS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#ifdef OPENGL_HAS_OSMESA
+#include <GL/osmesa.h>
+#endif
+
+#include "errors.hpp"
+#include "frame_arena.hpp"
+
+static double now()
+{
+    using clock = std::chrono::steady_clock;
+    return std::chrono::duration<double>(clock::now().time_since_epoch()).count();
+}
+
+static void report_live_names()
+{
+#if GL_COUNTERS
+    const GLLiveNames& names = gl_live_names();
+
+    if (names.buffers != 0 || names.vertex_arrays != 0 || names.programs != 0) {
+        std::cerr << "WARNING: GL names still alive at shutdown: "
+                  << names.buffers << " buffers, "
+                  << names.vertex_arrays << " vertex arrays, "
+                  << names.programs << " programs" << std::endl;
+    }
+#endif
+}
+
+bool parse_context_backend(std::string_view name, ContextBackend& backend)
+{
+    if (name == "window") {
+        backend = ContextBackend::Window;
+    } else if (name == "egl") {
+        backend = ContextBackend::EGL;
+    } else if (name == "osmesa") {
+        backend = ContextBackend::OSMesa;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+const char* context_backend_name(ContextBackend backend)
+{
+    switch (backend) {
+    case ContextBackend::Window: return "window";
+    case ContextBackend::EGL:    return "egl";
+    case ContextBackend::OSMesa: return "osmesa";
+    }
+
+    return "unknown";
+}
+
+ContextSettings context_settings_from_args(int& argc, char** argv)
+{
+    ContextSettings settings;
+
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+
+        if (arg == "--headless") {
+            settings.backend = ContextBackend::EGL;
+        } else if (arg.starts_with("--headless=")) {
+            if (!parse_context_backend(arg.substr(11), settings.backend)) {
+                std::cerr << "WARNING: unknown context backend `"
+                          << arg.substr(11) << "`" << std::endl;
+            }
+        } else if (arg == "--frames" && i + 1 < argc) {
+            settings.max_frames = std::atol(argv[++i]);
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+
+    argc = kept;
+    argv[argc] = nullptr;
+
+    return settings;
+}
+
+Context::Context(const ContextSettings& settings)
+    : m_settings(settings),
+      m_window(nullptr),
+      m_egl_display(nullptr), m_egl_surface(nullptr), m_egl_context(nullptr),
+      m_osmesa_context(nullptr),
+      m_fbo(0), m_color_rb(0),
+      m_frame(0), m_frame_start(0)
+{
+    switch (m_settings.backend) {
+    case ContextBackend::Window:
+        valid = create_window();
+        break;
+    case ContextBackend::EGL:
+        valid = create_egl();
+        break;
+    case ContextBackend::OSMesa:
+        valid = create_osmesa();
+        break;
+    }
+
+    if (!valid)
+        return;
+
+    // Without GLX, `glewInit` fails looking for a GLX display,
+    // `glewContextInit` only loads the functions for the current context.
+    GLenum result = m_settings.backend == ContextBackend::Window ? glewInit()
+                                                                 : glewContextInit();
+    if (result != GLEW_OK) {
+        std::cerr << "ERROR: could not initialize GLEW" << std::endl;
+        valid = false;
+        return;
+    }
+
+    if (m_egl_context && !m_egl_surface)
+        valid = create_default_framebuffer();
+
+    // No reallocation while frames run, when we know how many there are.
+    m_frame_times.reserve(m_settings.max_frames);
+
+    m_frame_start = now();
+}
+
+Context::~Context()
+{
+    if (valid)
+        report_live_names();
+
+    if (m_fbo) {
+        glDeleteFramebuffers(1, &m_fbo);
+        glDeleteRenderbuffers(1, &m_color_rb);
+    }
+
+    if (m_window) {
+        glfwDestroyWindow(m_window);
+        glfwTerminate();
+    }
+
+#ifdef OPENGL_HAS_EGL
+    if (m_egl_display) {
+        EGLDisplay display = (EGLDisplay)m_egl_display;
+
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+        if (m_egl_context)
+            eglDestroyContext(display, (EGLContext)m_egl_context);
+        if (m_egl_surface)
+            eglDestroySurface(display, (EGLSurface)m_egl_surface);
+
+        eglTerminate(display);
+    }
+#endif
+
+#ifdef OPENGL_HAS_OSMESA
+    if (m_osmesa_context)
+        OSMesaDestroyContext((OSMesaContext)m_osmesa_context);
+#endif
+}
+
+bool Context::create_window()
+{
+    if (!glfwInit()) {
+        std::cerr << "ERROR: could not initialize GLFW" << std::endl;
+        return false;
+    }
+
+    if (!m_settings.visible)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    if (m_settings.version_major != 0) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, m_settings.version_major);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, m_settings.version_minor);
+    }
+
+    m_window = glfwCreateWindow(m_settings.width, m_settings.height,
+                                m_settings.title.c_str(), nullptr, nullptr);
+    if (!m_window) {
+        std::cerr << "ERROR: could not create GLFW window" << std::endl;
+        glfwTerminate();
+        return false;
+    }
+
+    glfwMakeContextCurrent(m_window);
+
+    if (!m_settings.vsync)
+        glfwSwapInterval(0);
+
+    return true;
+}
+
+bool Context::create_egl()
+{
+#ifdef OPENGL_HAS_EGL
+    // Mesa can create contexts without any display server at all.
+    EGLDisplay display = EGL_NO_DISPLAY;
+
+    auto get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC)
+        eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (get_platform_display) {
+        display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA,
+                                       EGL_DEFAULT_DISPLAY, nullptr);
+    }
+
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        std::cerr << "ERROR: could not initialize EGL" << std::endl;
+        return false;
+    }
+
+    m_egl_display = display;
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "ERROR: EGL doesn't support OpenGL" << std::endl;
+        return false;
+    }
+
+    const EGLint config_attributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_NONE,
+    };
+
+    EGLConfig config = nullptr;
+    EGLint config_count = 0;
+    eglChooseConfig(display, config_attributes, &config, 1, &config_count);
+
+    EGLint context_attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, m_settings.version_major,
+        EGL_CONTEXT_MINOR_VERSION, m_settings.version_minor,
+        EGL_NONE,
+    };
+
+    // Without a version, let EGL pick (like GLFW does).
+    if (m_settings.version_major == 0)
+        context_attributes[0] = EGL_NONE;
+
+    // Without a pbuffer config, fall back to a surfaceless
+    // context (EGL_KHR_surfaceless_context).
+    EGLConfig context_config = config_count > 0 ? config : EGL_NO_CONFIG_KHR;
+
+    EGLContext context = eglCreateContext(display, context_config, EGL_NO_CONTEXT,
+                                          context_attributes);
+    if (context == EGL_NO_CONTEXT) {
+        std::cerr << "ERROR: could not create EGL context" << std::endl;
+        return false;
+    }
+
+    m_egl_context = context;
+
+    EGLSurface surface = EGL_NO_SURFACE;
+    if (config_count > 0) {
+        const EGLint surface_attributes[] = {
+            EGL_WIDTH, m_settings.width,
+            EGL_HEIGHT, m_settings.height,
+            EGL_NONE,
+        };
+
+        surface = eglCreatePbufferSurface(display, config, surface_attributes);
+        if (surface != EGL_NO_SURFACE)
+            m_egl_surface = surface;
+    }
+
+    if (!eglMakeCurrent(display, surface, surface, context)) {
+        std::cerr << "ERROR: could not make EGL context current" << std::endl;
+        return false;
+    }
+
+    return true;
+#else
+    std::cerr << "ERROR: built without EGL support" << std::endl;
+    return false;
+#endif
+}
+
+bool Context::create_osmesa()
+{
+#ifdef OPENGL_HAS_OSMESA
+    const int attributes[] = {
+        OSMESA_FORMAT, OSMESA_RGBA,
+        OSMESA_DEPTH_BITS, 24,
+        OSMESA_CONTEXT_MAJOR_VERSION, m_settings.version_major ? m_settings.version_major : 3,
+        OSMESA_CONTEXT_MINOR_VERSION, m_settings.version_major ? m_settings.version_minor : 3,
+        0,
+    };
+
+    OSMesaContext context = OSMesaCreateContextAttribs(attributes, nullptr);
+    if (!context) {
+        std::cerr << "ERROR: could not create OSMesa context" << std::endl;
+        return false;
+    }
+
+    m_osmesa_context = context;
+    m_osmesa_buffer.resize((std::size_t)m_settings.width * m_settings.height * 4);
+
+    if (!OSMesaMakeCurrent(context, m_osmesa_buffer.data(), GL_UNSIGNED_BYTE,
+                           m_settings.width, m_settings.height)) {
+        std::cerr << "ERROR: could not make OSMesa context current" << std::endl;
+        return false;
+    }
+
+    return true;
+#else
+    std::cerr << "ERROR: built without OSMesa support" << std::endl;
+    return false;
+#endif
+}
+
+bool Context::create_default_framebuffer()
+{
+    gl(GenRenderbuffers, 1, &m_color_rb);
+    gl(BindRenderbuffer, GL_RENDERBUFFER, m_color_rb);
+    gl(RenderbufferStorage, GL_RENDERBUFFER, GL_RGBA8, m_settings.width, m_settings.height);
+
+    gl(GenFramebuffers, 1, &m_fbo);
+    gl(BindFramebuffer, GL_FRAMEBUFFER, m_fbo);
+    gl(FramebufferRenderbuffer, GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                GL_RENDERBUFFER, m_color_rb);
+
+    GLenum status;
+    gl_call(status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "ERROR: could not create framebuffer for surfaceless context" << std::endl;
+        return false;
+    }
+
+    gl(Viewport, 0, 0, m_settings.width, m_settings.height);
+
+    return true;
+}
+
+bool Context::should_close() const
+{
+    if (m_settings.max_frames != 0 && m_frame >= m_settings.max_frames)
+        return true;
+
+    if (m_window)
+        return glfwWindowShouldClose(m_window);
+
+    return false;
+}
+
+void Context::swap_buffers()
+{
+    switch (m_settings.backend) {
+    case ContextBackend::Window:
+        glfwSwapBuffers(m_window);
+        break;
+    case ContextBackend::EGL:
+#ifdef OPENGL_HAS_EGL
+        if (m_egl_surface) {
+            eglSwapBuffers((EGLDisplay)m_egl_display, (EGLSurface)m_egl_surface);
+            break;
+        }
+#endif
+        // Nothing is ever presented, wait for the frame
+        // so the frame times mean something.
+        glFinish();
+        break;
+    case ContextBackend::OSMesa:
+        glFinish();
+        break;
+    }
+
+    double end = now();
+    m_frame_times.push_back(end - m_frame_start);
+    m_frame_start = end;
+
+    frame_arena().next_frame();
+
+    m_frame++;
+}
+
+void Context::poll_events()
+{
+    if (m_window)
+        glfwPollEvents();
+}
+
+bool Context::make_current()
+{
+    bool ok = true;
+
+    switch (m_settings.backend) {
+    case ContextBackend::Window:
+        glfwMakeContextCurrent(m_window);
+        break;
+    case ContextBackend::EGL:
+#ifdef OPENGL_HAS_EGL
+        ok = eglMakeCurrent((EGLDisplay)m_egl_display, (EGLSurface)m_egl_surface,
+                            (EGLSurface)m_egl_surface, (EGLContext)m_egl_context);
+#endif
+        break;
+    case ContextBackend::OSMesa:
+#ifdef OPENGL_HAS_OSMESA
+        ok = OSMesaMakeCurrent((OSMesaContext)m_osmesa_context, m_osmesa_buffer.data(),
+                               GL_UNSIGNED_BYTE, m_settings.width, m_settings.height);
+#endif
+        break;
+    }
+
+    if (!ok)
+        std::cerr << "ERROR: could not make the context current" << std::endl;
+
+    return ok;
+}
+
+void Context::release_current()
+{
+    switch (m_settings.backend) {
+    case ContextBackend::Window:
+        glfwMakeContextCurrent(nullptr);
+        break;
+    case ContextBackend::EGL:
+#ifdef OPENGL_HAS_EGL
+        eglMakeCurrent((EGLDisplay)m_egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                       EGL_NO_CONTEXT);
+#endif
+        break;
+    case ContextBackend::OSMesa:
+#ifdef OPENGL_HAS_OSMESA
+        OSMesaMakeCurrent(nullptr, nullptr, 0, 0, 0);
+#endif
+        break;
+    }
+}
+
+void Context::report_frame_times() const
+{
+    if (m_frame_times.empty())
+        return;
+
+    std::vector<double> sorted = m_frame_times;
+    std::sort(sorted.begin(), sorted.end());
+
+    double total = 0;
+    for (double time : sorted) {
+        total += time;
+    }
+
+    std::size_t p99 = std::min(sorted.size() - 1, sorted.size() * 99 / 100);
+
+    std::cout << "INFO: " << sorted.size() << " frames ("
+              << context_backend_name(m_settings.backend) << ")" << std::endl;
+    std::cout << " > average: " << total / sorted.size() * 1000.0 << " ms" << std::endl;
+    std::cout << " > minimum: " << sorted.front() * 1000.0 << " ms" << std::endl;
+    std::cout << " > maximum: " << sorted.back() * 1000.0 << " ms" << std::endl;
+    std::cout << " > p99:     " << sorted[p99] * 1000.0 << " ms" << std::endl;
+}
\ No newline at end of file
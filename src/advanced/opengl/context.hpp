@@ -0,0 +1,110 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+// Headless backends are only available when built with
+// `-DOPENGL_HAS_EGL` / `-DOPENGL_HAS_OSMESA` (see build.sh).
+enum class ContextBackend {
+    // A GLFW window, needs a display.
+    Window,
+    // An EGL pbuffer (or surfaceless context rendering to a
+    // framebuffer object), e.g. Mesa's llvmpipe without a display.
+    EGL,
+    // Mesa's off-screen rendering into a buffer in system memory.
+    OSMesa,
+};
+
+struct ContextSettings {
+    ContextBackend backend = ContextBackend::Window;
+
+    int width = 640;
+    int height = 480;
+    std::string title = "OpenGL Application";
+    bool visible = true;
+    // Only affects windows, headless swaps never wait.
+    bool vsync = true;
+
+    // 0 means whatever the backend gives by default.
+    int version_major = 0;
+    int version_minor = 0;
+
+    // Makes `should_close` return true after this many frames,
+    // 0 means never. Headless contexts can't be closed otherwise.
+    std::size_t max_frames = 0;
+};
+
+// Understands `--headless[=egl|osmesa]` and `--frames N` and removes
+// them from `argv` (like `glutInit`), other arguments are left alone.
+ContextSettings context_settings_from_args(int& argc, char** argv);
+
+bool parse_context_backend(std::string_view name, ContextBackend& backend);
+const char* context_backend_name(ContextBackend backend);
+
+// An OpenGL context made current on creation, with GLEW initialized.
+// Also keeps track of how long every frame took.
+class Context {
+private:
+    ContextSettings m_settings;
+
+    GLFWwindow* m_window;
+
+    void* m_egl_display;
+    void* m_egl_surface;
+    void* m_egl_context;
+
+    void* m_osmesa_context;
+    std::vector<unsigned char> m_osmesa_buffer;
+
+    // Used when a surfaceless context has no default framebuffer.
+    GLuint m_fbo;
+    GLuint m_color_rb;
+
+    // `should_close` may be called from another thread than `swap_buffers`.
+    std::atomic<std::size_t> m_frame;
+    double m_frame_start;
+    std::vector<double> m_frame_times;
+
+    bool create_window();
+    bool create_egl();
+    bool create_osmesa();
+    bool create_default_framebuffer();
+
+public:
+    bool valid;
+
+    Context(const ContextSettings& settings);
+    // Warns about GL names still alive, see `gl_live_names`. Everything
+    // using the context must be destroyed before it.
+    ~Context();
+
+    Context(const Context&) = delete;
+    Context& operator=(const Context&) = delete;
+
+    bool should_close() const;
+    void swap_buffers();
+    void poll_events();
+
+    // The context is current on the thread that created it. To render on
+    // another thread (see `RenderThread`), release it there first: it can
+    // only be current on one thread at a time. Window events must still
+    // be polled on the thread that created the context.
+    bool make_current();
+    void release_current();
+
+    inline ContextBackend get_backend() const { return m_settings.backend; }
+    inline GLFWwindow* get_window() const { return m_window; }
+    inline std::size_t get_frame() const { return m_frame; }
+
+    // Duration of every frame so far, in seconds.
+    inline const std::vector<double>& get_frame_times() const { return m_frame_times; }
+
+    // Prints the average, minimum, maximum and 99th percentile frame time.
+    void report_frame_times() const;
+};
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+// Build with `-DGL_COUNTERS=0` to compile the counting out.
+#ifndef GL_COUNTERS
+#define GL_COUNTERS 1
+#endif
+
+// Filled in by the `gl()` macro and the wrappers in `opengl/`,
+// `Profiler::end_frame` reads and resets them every frame.
+struct GLCounters {
+    std::size_t gl_calls = 0;
+    std::size_t draw_calls = 0;
+    std::size_t bytes_uploaded = 0;
+};
+
+inline GLCounters& gl_counters()
+{
+    static GLCounters counters;
+    return counters;
+}
+
+// GL names created by the wrappers in `opengl/` and not deleted yet.
+// Never reset: whatever is left when the context is destroyed leaked
+// (see `Context::~Context`).
+struct GLLiveNames {
+    std::ptrdiff_t buffers = 0;
+    std::ptrdiff_t vertex_arrays = 0;
+    std::ptrdiff_t programs = 0;
+};
+
+inline GLLiveNames& gl_live_names()
+{
+    static GLLiveNames names;
+    return names;
+}
+
+// `name` is what's passed to `gl()`, so without the `gl` prefix.
+// Draws made with `gl_call()` aren't recognized, only counted as calls.
+constexpr bool gl_is_draw_call(std::string_view name)
+{
+    return name.starts_with("Draw") || name.starts_with("MultiDraw");
+}
+
+#if GL_COUNTERS
+
+#define gl_count_call(name)                        \
+    do {                                           \
+        gl_counters().gl_calls++;                  \
+        if constexpr (gl_is_draw_call(#name))      \
+            gl_counters().draw_calls++;            \
+    } while (0)
+
+#define gl_count_upload(bytes) (gl_counters().bytes_uploaded += (bytes))
+
+// `kind` is a member of `GLLiveNames`, `count` is negative for deletions.
+#define gl_count_names(kind, count) (gl_live_names().kind += (count))
+
+#else
+
+#define gl_count_call(name) do {} while (0)
+#define gl_count_upload(bytes) do {} while (0)
+#define gl_count_names(kind, count) do {} while (0)
+
+#endif
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include "draw_indirect_buffer.hpp"
+
+#include <utility>
+
+#include "errors.hpp"
+#include "state_cache.hpp"
+
+DrawIndirectBuffer::DrawIndirectBuffer()
+    : m_capacity(0), m_uploaded(0), m_instances(0)
+{
+    gl(GenBuffers, 1, &m_buffer);
+    gl_count_names(buffers, 1);
+}
+
+DrawIndirectBuffer::~DrawIndirectBuffer()
+{
+    if (!m_buffer)
+        return;
+
+    gl(DeleteBuffers, 1, &m_buffer);
+    gl_count_names(buffers, -1);
+    gl_state().forget_buffer(m_buffer);
+}
+
+DrawIndirectBuffer::DrawIndirectBuffer(DrawIndirectBuffer&& other)
+    : m_buffer(std::exchange(other.m_buffer, 0)),
+      m_capacity(std::exchange(other.m_capacity, 0)),
+      m_uploaded(std::exchange(other.m_uploaded, 0)),
+      m_instances(std::exchange(other.m_instances, 0)),
+      m_commands(std::move(other.m_commands))
+{
+}
+
+DrawIndirectBuffer& DrawIndirectBuffer::operator=(DrawIndirectBuffer&& other)
+{
+    // `other` deletes what this buffer had.
+    std::swap(m_buffer, other.m_buffer);
+    std::swap(m_capacity, other.m_capacity);
+    std::swap(m_uploaded, other.m_uploaded);
+    std::swap(m_instances, other.m_instances);
+    std::swap(m_commands, other.m_commands);
+
+    return *this;
+}
+
+std::size_t DrawIndirectBuffer::add(const MeshRange& mesh, std::size_t instances)
+{
+    return add({
+        (GLuint)mesh.count,
+        (GLuint)instances,
+        (GLuint)mesh.first_index,
+        mesh.base_vertex,
+        (GLuint)m_instances,
+    });
+}
+
+std::size_t DrawIndirectBuffer::add(const DrawElementsIndirectCommand& command)
+{
+    m_commands.push_back(command);
+
+    std::size_t end = (std::size_t)command.base_instance + command.instance_count;
+    if (end > m_instances)
+        m_instances = end;
+
+    return m_commands.size() - 1;
+}
+
+void DrawIndirectBuffer::clear()
+{
+    m_commands.clear();
+    m_instances = 0;
+}
+
+void DrawIndirectBuffer::upload()
+{
+    std::size_t size = m_commands.size() * sizeof(DrawElementsIndirectCommand);
+
+    gl_state().bind_buffer(GL_DRAW_INDIRECT_BUFFER, m_buffer);
+
+    if (m_commands.size() > m_capacity) {
+        m_capacity = m_commands.size();
+        gl(BufferData, GL_DRAW_INDIRECT_BUFFER, size, m_commands.data(), GL_DYNAMIC_DRAW);
+    } else {
+        gl(BufferData, GL_DRAW_INDIRECT_BUFFER, m_capacity * sizeof(DrawElementsIndirectCommand),
+                       nullptr, GL_DYNAMIC_DRAW);
+        gl(BufferSubData, GL_DRAW_INDIRECT_BUFFER, 0, size, m_commands.data());
+    }
+
+    gl_count_upload(size);
+
+    m_uploaded = m_commands.size();
+}
+
+void DrawIndirectBuffer::bind() const
+{
+    gl_state().bind_buffer(GL_DRAW_INDIRECT_BUFFER, m_buffer);
+}
+
+void DrawIndirectBuffer::unbind() const
+{
+    gl_state().bind_buffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void DrawIndirectBuffer::draw(const VertexArray& va, GLenum mode) const
+{
+    if (m_uploaded == 0)
+        return;
+
+    gl(MultiDrawElementsIndirect, mode, va.get_index_type(), nullptr, m_uploaded, 0);
+}
+
+bool multi_draw_indirect_supported()
+{
+    return GLEW_ARB_multi_draw_indirect || GLEW_VERSION_4_3;
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+#include <cstddef>
+
+#include "vertex_array.hpp"
+#include "mesh.hpp"
+
+// The layout `glMultiDrawElementsIndirect` reads.
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instance_count;
+    GLuint first_index;
+    GLint base_vertex;
+    GLuint base_instance;
+};
+
+// Draws of meshes sharing one vertex array (see `append_mesh`), all
+// submitted with a single `glMultiDrawElementsIndirect`: the CPU cost
+// doesn't grow with the number of draws.
+//
+// Unless set otherwise, the `base_instance` of a draw is the number of
+// instances added before it, so per-instance data can be read from an
+// instanced attribute (divisor 1) fed by a buffer with an entry per
+// instance, in the order the draws were added (draw 0's instances, then
+// draw 1's...). With one instance per draw, that's an entry per draw
+// (e.g. resources/instanced_color.glsl). See `get_instance_count`.
+//
+// Commands are written on the CPU and sent with `upload`.
+// Needs GL 4.3 (see `multi_draw_indirect_supported`).
+class DrawIndirectBuffer {
+private:
+    GLuint m_buffer;
+    // Of the GL buffer, in commands.
+    std::size_t m_capacity;
+    std::size_t m_uploaded;
+    // The `base_instance` of the next draw added from a `MeshRange`.
+    std::size_t m_instances;
+
+    std::vector<DrawElementsIndirectCommand> m_commands;
+
+public:
+    DrawIndirectBuffer();
+    ~DrawIndirectBuffer();
+
+    DrawIndirectBuffer(const DrawIndirectBuffer&) = delete;
+    DrawIndirectBuffer& operator=(const DrawIndirectBuffer&) = delete;
+    // A moved-from buffer owns nothing.
+    DrawIndirectBuffer(DrawIndirectBuffer&& other);
+    DrawIndirectBuffer& operator=(DrawIndirectBuffer&& other);
+
+    // Returns the index of the draw.
+    std::size_t add(const MeshRange& mesh, std::size_t instances = 1);
+    // Draws added after this one start after its instances.
+    std::size_t add(const DrawElementsIndirectCommand& command);
+
+    inline DrawElementsIndirectCommand& get_command(std::size_t index)
+    {
+        return m_commands[index];
+    }
+
+    inline std::size_t get_size() const { return m_commands.size(); }
+    // How many entries the per-instance buffer needs.
+    inline std::size_t get_instance_count() const { return m_instances; }
+    inline GLuint get_id() const { return m_buffer; }
+
+    void clear();
+
+    // Sends every command. The GL buffer grows as needed, and is
+    // orphaned otherwise so this doesn't wait for draws reading it.
+    void upload();
+
+    void bind() const;
+    void unbind() const;
+
+    // Draws what was last uploaded. The buffer and `va` (the vertex
+    // array the meshes were appended to) must be bound.
+    void draw(const VertexArray& va, GLenum mode = GL_TRIANGLES) const;
+};
+
+bool multi_draw_indirect_supported();
\ No newline at end of file
@@ -0,0 +1,235 @@
+#include "draw_queue.hpp"
+
+#include <array>
+#include <barrier>
+#include <thread>
+#include <utility>
+
+#include "parallel.hpp"
+#include "frame_arena.hpp"
+
+// Below this many items per thread, starting the
+// threads costs more than sorting on fewer of them.
+static const std::size_t MIN_SORT_ITEMS_PER_THREAD = 16384;
+
+DrawQueue::DrawQueue(std::size_t recorders, unsigned int threads)
+    : m_recorders(recorders), m_threads(resolve_thread_count(threads)), m_stats()
+{
+}
+
+// Only reads the keys, which are next to each other in memory.
+template <typename Entries>
+static DrawStateChanges count_state_changes(const Entries& entries)
+{
+    DrawStateChanges changes = {};
+
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        std::uint64_t key = entries[i].key;
+        std::uint64_t previous = i == 0 ? ~key : entries[i - 1].key;
+
+        if (get_draw_key_shader(key) != get_draw_key_shader(previous))
+            changes.shaders++;
+        if (get_draw_key_vertex_array(key) != get_draw_key_vertex_array(previous))
+            changes.vertex_arrays++;
+        if (get_draw_key_material(key) != get_draw_key_material(previous))
+            changes.materials++;
+    }
+
+    return changes;
+}
+
+void DrawQueue::sort()
+{
+    std::size_t* offsets = frame_arena().allocate_array<std::size_t>(m_recorders.size());
+    std::size_t count = 0;
+
+    for (std::size_t i = 0; i < m_recorders.size(); ++i) {
+        offsets[i] = count;
+        count += m_recorders[i].m_items.size();
+    }
+
+    m_entries.resize(count);
+
+    parallel_for(m_recorders.size(), m_threads, [&](std::size_t i) {
+        const std::vector<DrawItem>& items = m_recorders[i].m_items;
+        Entry* entries = m_entries.data() + offsets[i];
+
+        for (std::size_t j = 0; j < items.size(); ++j) {
+            entries[j] = { items[j].key, &items[j] };
+        }
+    });
+
+    m_stats.items = count;
+    m_stats.unsorted = count_state_changes(m_entries);
+
+    radix_sort();
+
+    m_stats.sorted = count_state_changes(m_entries);
+}
+
+// Least significant byte first, each pass being stable. Every thread
+// counts the digits of its part of the entries, then (once the counts
+// are turned into offsets) writes its entries where they go.
+void DrawQueue::radix_sort()
+{
+    std::size_t count = m_entries.size();
+    if (count < 2)
+        return;
+
+    // Bytes that are the same in every key don't need a pass. With a few
+    // layers, shaders and vertex arrays, that's most of the high ones.
+    std::uint64_t varying = 0;
+    for (const Entry& entry : m_entries) {
+        varying |= entry.key ^ m_entries[0].key;
+    }
+
+    unsigned int shifts[8];
+    unsigned int pass_count = 0;
+    for (unsigned int shift = 0; shift < 64; shift += 8) {
+        if ((varying >> shift) & 0xff)
+            shifts[pass_count++] = shift;
+    }
+
+    if (pass_count == 0)
+        return;
+
+    m_scratch.resize(count);
+
+    unsigned int threads = std::max<std::size_t>(1, std::min<std::size_t>(
+        m_threads, count / MIN_SORT_ITEMS_PER_THREAD));
+
+    // Digit counts of each thread, then where it writes each digit.
+    using Digits = std::array<std::size_t, 256>;
+    Digits* digits = frame_arena().allocate_array<Digits>(threads);
+
+    auto to_offsets = [&]() noexcept {
+        std::size_t offset = 0;
+
+        for (std::size_t digit = 0; digit < 256; ++digit) {
+            for (unsigned int thread = 0; thread < threads; ++thread) {
+                std::size_t digit_count = digits[thread][digit];
+                digits[thread][digit] = offset;
+                offset += digit_count;
+            }
+        }
+    };
+
+    auto worker = [&](unsigned int thread, auto& counted, auto& written) {
+        std::size_t begin = count * thread / threads;
+        std::size_t end = count * (thread + 1) / threads;
+
+        Entry* from = m_entries.data();
+        Entry* to = m_scratch.data();
+        Digits& offsets = digits[thread];
+
+        for (unsigned int pass = 0; pass < pass_count; ++pass) {
+            unsigned int shift = shifts[pass];
+
+            offsets.fill(0);
+            for (std::size_t i = begin; i < end; ++i) {
+                offsets[(from[i].key >> shift) & 0xff]++;
+            }
+
+            counted.arrive_and_wait();
+
+            for (std::size_t i = begin; i < end; ++i) {
+                to[offsets[(from[i].key >> shift) & 0xff]++] = from[i];
+            }
+
+            // The next pass reads what every thread wrote.
+            written.arrive_and_wait();
+
+            std::swap(from, to);
+        }
+    };
+
+    if (threads == 1) {
+        // Nothing to wait for. A `std::barrier` would allocate, and sorting
+        // on one thread shouldn't touch the heap once the vectors are big
+        // enough.
+        struct {
+            decltype(to_offsets)& completion;
+            void arrive_and_wait() { completion(); }
+        } counted { to_offsets };
+        struct {
+            void arrive_and_wait() {}
+        } written;
+
+        worker(0, counted, written);
+    } else {
+        std::barrier counted(threads, to_offsets);
+        std::barrier written(threads);
+
+        std::vector<std::thread> workers;
+        for (unsigned int i = 1; i < threads; ++i) {
+            workers.emplace_back([&, i]() { worker(i, counted, written); });
+        }
+
+        worker(0, counted, written);
+
+        for (std::thread& thread : workers) {
+            thread.join();
+        }
+    }
+
+    if (pass_count % 2 == 1)
+        m_entries.swap(m_scratch);
+}
+
+void DrawQueue::record(CommandBuffer& buffer) const
+{
+    Shader* shader = nullptr;
+    const VertexArray* vertex_array = nullptr;
+
+    for (const Entry& entry : m_entries) {
+        const DrawItem& item = *entry.item;
+
+        if (item.shader != shader) {
+            shader = item.shader;
+            buffer.bind_shader(*shader);
+        }
+
+        if (item.vertex_array != vertex_array) {
+            vertex_array = item.vertex_array;
+            buffer.bind_vertex_array(*vertex_array);
+        }
+
+        for (std::uint32_t i = 0; i < item.uniform_count; ++i) {
+            const DrawUniform& uniform = item.uniforms[i];
+            const float* v = uniform.values;
+
+            switch (uniform.size) {
+            case 1:
+                buffer.set_uniform_1f(*shader, uniform.handle, v[0]);
+                break;
+            case 2:
+                buffer.set_uniform_2f(*shader, uniform.handle, v[0], v[1]);
+                break;
+            default:
+                buffer.set_uniform_4f(*shader, uniform.handle, v[0], v[1], v[2], v[3]);
+                break;
+            }
+        }
+
+        if (item.instances == 1)
+            buffer.draw_elements(*vertex_array, item.count, item.mode);
+        else
+            buffer.draw_elements_instanced(*vertex_array, item.count, item.instances, item.mode);
+    }
+}
+
+void DrawQueue::submit()
+{
+    record(m_commands);
+    m_commands.execute();
+    m_commands.reset();
+}
+
+void DrawQueue::clear()
+{
+    for (DrawRecorder& recorder : m_recorders) {
+        recorder.m_items.clear();
+    }
+
+    m_entries.clear();
+}
\ No newline at end of file
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+
+#include "shader.hpp"
+#include "vertex_array.hpp"
+#include "command_buffer.hpp"
+
+// Builds the 64-bit sort key of a draw. From the most significant bits:
+// layer (4 bits), shader (16), vertex array (16), material (16) and depth
+// (12, from 0 to 1). Sorting by it draws layer by layer, and within a
+// layer groups the draws using the same program, then the same vertex
+// array and the same material, front to back. Only the low bits of the
+// GL names are used: two names sharing them only cost a state change.
+inline std::uint64_t make_draw_key(unsigned int layer, GLuint shader, GLuint vertex_array,
+                                   unsigned int material, float depth)
+{
+    std::uint64_t depth_bits = (std::uint64_t)(std::clamp(depth, 0.0f, 1.0f) * 4095.0f);
+
+    return (std::uint64_t)(layer & 0xf) << 60
+         | (std::uint64_t)(shader & 0xffff) << 44
+         | (std::uint64_t)(vertex_array & 0xffff) << 28
+         | (std::uint64_t)(material & 0xffff) << 12
+         | depth_bits;
+}
+
+inline unsigned int get_draw_key_shader(std::uint64_t key)
+{
+    return (key >> 44) & 0xffff;
+}
+
+inline unsigned int get_draw_key_vertex_array(std::uint64_t key)
+{
+    return (key >> 28) & 0xffff;
+}
+
+inline unsigned int get_draw_key_material(std::uint64_t key)
+{
+    return (key >> 12) & 0xffff;
+}
+
+const std::size_t DRAW_ITEM_UNIFORMS = 2;
+
+// A uniform set right before a draw.
+struct DrawUniform {
+    UniformHandle handle;
+    // 1, 2 or 4 floats.
+    std::uint32_t size;
+    float values[4];
+};
+
+struct DrawItem {
+    std::uint64_t key;
+    Shader* shader;
+    const VertexArray* vertex_array;
+    GLenum mode;
+    std::uint32_t count;
+    std::uint32_t instances;
+
+    std::uint32_t uniform_count;
+    DrawUniform uniforms[DRAW_ITEM_UNIFORMS];
+
+    // Items have room for `DRAW_ITEM_UNIFORMS` uniforms. Returns false,
+    // and sets nothing, once it's full.
+    inline bool set_uniform(UniformHandle handle, std::uint32_t size,
+                            float x, float y = 0, float z = 0, float w = 0)
+    {
+        if (uniform_count == DRAW_ITEM_UNIFORMS)
+            return false;
+
+        uniforms[uniform_count++] = { handle, size, { x, y, z, w } };
+        return true;
+    }
+};
+
+// Where one thread records its draws. Nothing is allocated once it has
+// grown to the size of a frame. Aligned so that two recorders never
+// share a cache line.
+class alignas(64) DrawRecorder {
+private:
+    std::vector<DrawItem> m_items;
+
+    friend class DrawQueue;
+
+public:
+    // Returns the item, to add uniforms to it. `count` and `instances`
+    // are kept in 32 bits, like the `GLsizei` they end up as.
+    inline DrawItem& draw(std::uint64_t key, Shader& shader, const VertexArray& va,
+                          std::size_t count, std::size_t instances = 1,
+                          GLenum mode = GL_TRIANGLES)
+    {
+        assert(count <= UINT32_MAX && instances <= UINT32_MAX);
+
+        DrawItem& item = m_items.emplace_back();
+        item.key = key;
+        item.shader = &shader;
+        item.vertex_array = &va;
+        item.mode = mode;
+        item.count = count;
+        item.instances = instances;
+        item.uniform_count = 0;
+
+        return item;
+    }
+
+    inline std::size_t get_size() const { return m_items.size(); }
+};
+
+// How many times the program, the vertex array and the material change
+// while drawing the items in order, counted from the keys.
+struct DrawStateChanges {
+    std::size_t shaders;
+    std::size_t vertex_arrays;
+    std::size_t materials;
+};
+
+struct DrawQueueStats {
+    std::size_t items;
+    // In the order the items were recorded (recorder by recorder).
+    DrawStateChanges unsorted;
+    DrawStateChanges sorted;
+};
+
+// Collects draws recorded by many threads, each into its own
+// `DrawRecorder`, sorts them by key and submits them:
+//
+//     // On thread `i`:
+//     queue.get_recorder(i).draw(make_draw_key(...), shader, va, 6);
+//     // Once every thread is done:
+//     queue.sort();
+//     queue.submit();
+//     queue.clear();
+//
+// Sorting is a radix sort of (key, item) pairs, spread over threads.
+// Only shaders and vertex arrays that change between two items are
+// bound again.
+class DrawQueue {
+private:
+    struct Entry {
+        std::uint64_t key;
+        const DrawItem* item;
+    };
+
+    std::vector<DrawRecorder> m_recorders;
+    std::vector<Entry> m_entries;
+    std::vector<Entry> m_scratch;
+    unsigned int m_threads;
+
+    CommandBuffer m_commands;
+    DrawQueueStats m_stats;
+
+    void radix_sort();
+
+public:
+    // One recorder per recording thread, and `threads`
+    // threads to sort with (0 for one per core).
+    DrawQueue(std::size_t recorders, unsigned int threads = 0);
+
+    DrawQueue(const DrawQueue&) = delete;
+    DrawQueue& operator=(const DrawQueue&) = delete;
+
+    inline DrawRecorder& get_recorder(std::size_t index) { return m_recorders[index]; }
+    inline std::size_t get_recorder_count() const { return m_recorders.size(); }
+
+    // Gathers the items of every recorder, in order (for the statistics),
+    // and sorts them. Nothing must be recording.
+    void sort();
+    // Draws in the order of the last `sort`, through `Shader::bind`
+    // and `VertexArray::bind`.
+    void submit();
+    // Same, but into `buffer` (e.g. for a `RenderThread`).
+    void record(CommandBuffer& buffer) const;
+
+    // Forgets every item, keeping the memory for the next frame.
+    void clear();
+
+    // In the order of the last `sort`.
+    inline std::size_t get_size() const { return m_entries.size(); }
+    inline const DrawItem& get_item(std::size_t index) const { return *m_entries[index].item; }
+
+    inline const DrawQueueStats& get_stats() const { return m_stats; }
+};
\ No newline at end of file
@@ -15,4 +15,71 @@ void gl_check_errors()
         std::cerr << "ERROR: OpenGL error: error code 0x"
                   << std::hex << error << std::dec << std::endl;
     }
+}
+
+#if GL_ERROR_POLICY == GL_ERRORS_DEBUG
+
+// Set when the driver doesn't expose KHR_debug, so we
+// fall back to polling at frame boundaries.
+static bool debug_callback_missing = false;
+
+static void GLAPIENTRY debug_callback(GLenum source, GLenum type, GLuint id,
+                                      GLenum severity, GLsizei length,
+                                      const GLchar* message, const void* user)
+{
+    (void)source;
+    (void)length;
+    (void)user;
+
+    if (severity == GL_DEBUG_SEVERITY_NOTIFICATION)
+        return;
+
+    const char* level = type == GL_DEBUG_TYPE_ERROR ? "ERROR" : "WARNING";
+
+    std::cerr << level << ": OpenGL debug: (id 0x"
+              << std::hex << id << std::dec << ") "
+              << message << std::endl;
+}
+
+#endif
+
+void gl_init_errors()
+{
+#if GL_ERROR_POLICY == GL_ERRORS_DEBUG
+    if (!GLEW_KHR_debug && !GLEW_VERSION_4_3) {
+        std::cerr << "WARNING: KHR_debug is not available, "
+                  << "falling back to per-frame error checks" << std::endl;
+        debug_callback_missing = true;
+        return;
+    }
+
+    // Asynchronous output lets the driver report errors from
+    // whatever thread it likes without serializing every call.
+    glEnable(GL_DEBUG_OUTPUT);
+    glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebugMessageCallback(debug_callback, nullptr);
+#endif
+}
+
+void gl_frame_check_errors()
+{
+#if GL_ERROR_POLICY == GL_ERRORS_FRAME
+    gl_check_errors();
+#elif GL_ERROR_POLICY == GL_ERRORS_DEBUG
+    if (debug_callback_missing)
+        gl_check_errors();
+#endif
+}
+
+const char* gl_error_policy_name()
+{
+#if GL_ERROR_POLICY == GL_ERRORS_FULL
+    return "full";
+#elif GL_ERROR_POLICY == GL_ERRORS_FRAME
+    return "frame";
+#elif GL_ERROR_POLICY == GL_ERRORS_DEBUG
+    return "debug";
+#else
+    return "off";
+#endif
 }
\ No newline at end of file
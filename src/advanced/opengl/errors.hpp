@@ -1,18 +1,65 @@
 #pragma once
 
+#include "counters.hpp"
+
+// Error checking policies for the `gl()` and `gl_call()` macros.
+// Select one at build time with `-DGL_ERROR_POLICY=<policy>`.
+//
+//   GL_ERRORS_FULL  - poll `glGetError` around every call (default).
+//   GL_ERRORS_FRAME - poll once per frame in `gl_frame_check_errors()`.
+//   GL_ERRORS_DEBUG - never poll; errors are reported asynchronously
+//                     by the KHR_debug callback set up by `gl_init_errors()`.
+//   GL_ERRORS_OFF   - no checking at all.
+#define GL_ERRORS_OFF   0
+#define GL_ERRORS_FRAME 1
+#define GL_ERRORS_DEBUG 2
+#define GL_ERRORS_FULL  3
+
+#ifndef GL_ERROR_POLICY
+#define GL_ERROR_POLICY GL_ERRORS_FULL
+#endif
+
 void gl_clear_errors();
 void gl_check_errors();
 
+// Must be called once after GLEW is initialized.
+void gl_init_errors();
+
+// Must be called once per frame, right before swapping buffers.
+void gl_frame_check_errors();
+
+const char* gl_error_policy_name();
+
+#if GL_ERROR_POLICY == GL_ERRORS_FULL
+
 #define gl(name, ...)          \
     do {                       \
+        gl_count_call(name);   \
         gl_clear_errors();     \
         gl##name(__VA_ARGS__); \
         gl_check_errors();     \
     } while (0);
 
-#define gl_call(...)       \
-    do {                   \
-        gl_clear_errors(); \
-        __VA_ARGS__;       \
-        gl_check_errors(); \
-    } while (0);
\ No newline at end of file
+#define gl_call(...)         \
+    do {                     \
+        gl_count_call(call); \
+        gl_clear_errors();   \
+        __VA_ARGS__;         \
+        gl_check_errors();   \
+    } while (0);
+
+#else
+
+#define gl(name, ...)          \
+    do {                       \
+        gl_count_call(name);   \
+        gl##name(__VA_ARGS__); \
+    } while (0);
+
+#define gl_call(...)         \
+    do {                     \
+        gl_count_call(call); \
+        __VA_ARGS__;         \
+    } while (0);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "frame_arena.hpp"
+
+#include <new>
+#include <cstdint>
+
+FrameArena::FrameArena(std::size_t capacity)
+    : m_regions(), m_current(0), m_stats()
+{
+    // Allocated on first use, threads that never use
+    // their arena don't pay for it.
+    for (Region& region : m_regions)
+        region.capacity = capacity;
+
+    m_stats.capacity = capacity;
+}
+
+FrameArena::~FrameArena()
+{
+    for (Region& region : m_regions) {
+        reset(region);
+        ::operator delete(region.memory);
+    }
+}
+
+static std::size_t align_up(std::size_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+void* FrameArena::allocate(std::size_t size, std::size_t alignment)
+{
+    Region& region = m_regions[m_current];
+
+    if (!region.memory)
+        region.memory = (unsigned char*)::operator new(region.capacity);
+
+    m_stats.allocations++;
+    m_stats.bytes += size;
+
+    // `operator new` aligns to `max_align_t`, which is enough below that.
+    std::size_t offset = align_up(region.used, alignment);
+    if (alignment > alignof(std::max_align_t))
+        offset = align_up((std::uintptr_t)region.memory + region.used, alignment)
+                 - (std::uintptr_t)region.memory;
+
+    if (offset + size > region.capacity)
+        return allocate_overflow(size, alignment);
+
+    region.used = offset + size;
+    return region.memory + offset;
+}
+
+void* FrameArena::allocate_overflow(std::size_t size, std::size_t alignment)
+{
+    Region& region = m_regions[m_current];
+
+    unsigned char* memory = (unsigned char*)::operator new(sizeof(Overflow) + alignment + size);
+
+    Overflow* overflow = (Overflow*)memory;
+    overflow->next = region.overflows;
+    region.overflows = overflow;
+    region.overflow_bytes += size + alignment;
+
+    m_stats.overflows++;
+
+    std::uintptr_t data = align_up((std::uintptr_t)memory + sizeof(Overflow), alignment);
+    return (void*)data;
+}
+
+void FrameArena::reset(Region& region)
+{
+    std::size_t needed = region.used + region.overflow_bytes;
+
+    while (region.overflows) {
+        Overflow* next = region.overflows->next;
+        ::operator delete(region.overflows);
+        region.overflows = next;
+    }
+
+    // Grown to what the frame needed, so the next ones fit.
+    if (region.overflow_bytes) {
+        std::size_t capacity = region.capacity;
+        while (capacity < needed)
+            capacity *= 2;
+
+        ::operator delete(region.memory);
+        region.memory = (unsigned char*)::operator new(capacity);
+        region.capacity = capacity;
+    }
+
+    region.used = 0;
+    region.overflow_bytes = 0;
+}
+
+void FrameArena::next_frame()
+{
+    std::size_t used = m_regions[m_current].used + m_regions[m_current].overflow_bytes;
+    if (used > m_stats.peak_bytes)
+        m_stats.peak_bytes = used;
+
+    m_current = (m_current + 1) % FRAMES_IN_FLIGHT;
+    reset(m_regions[m_current]);
+
+    m_stats.allocations = 0;
+    m_stats.bytes = 0;
+    m_stats.capacity = m_regions[m_current].capacity;
+}
+
+FrameArena& frame_arena()
+{
+    thread_local FrameArena arena;
+    return arena;
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <type_traits>
+#include <cstddef>
+
+struct FrameArenaStats {
+    // In the current frame.
+    std::size_t allocations;
+    std::size_t bytes;
+    // The most bytes a frame has used.
+    std::size_t peak_bytes;
+    // Allocations that didn't fit and went to the heap, since the start.
+    // The arena grows at the next reset, so this stops increasing once
+    // it's big enough.
+    std::size_t overflows;
+    std::size_t capacity;
+};
+
+// A bump allocator for data that lives for one frame: allocating is
+// moving a pointer, and everything is freed at once when the frame
+// ends. There is a region for each frame in flight, so what a frame
+// allocated stays valid while the next one is recorded (e.g. on the
+// render thread, see `RenderThread`). Nothing is ever destroyed, only
+// trivially destructible types can go in it.
+class FrameArena {
+public:
+    static const std::size_t FRAMES_IN_FLIGHT = 2;
+    static const std::size_t DEFAULT_CAPACITY = 1 << 20;
+
+private:
+    struct Overflow {
+        Overflow* next;
+    };
+
+    struct Region {
+        unsigned char* memory;
+        std::size_t capacity;
+        std::size_t used;
+        // Heap allocations that didn't fit, freed at the reset.
+        Overflow* overflows;
+        std::size_t overflow_bytes;
+    };
+
+    Region m_regions[FRAMES_IN_FLIGHT];
+    std::size_t m_current;
+    FrameArenaStats m_stats;
+
+    void* allocate_overflow(std::size_t size, std::size_t alignment);
+    void reset(Region& region);
+
+public:
+    FrameArena(std::size_t capacity = DEFAULT_CAPACITY);
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Valid until the end of the frame after this one.
+    void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+    // Uninitialized storage for `count` objects.
+    template <typename T>
+    inline T* allocate_array(std::size_t count)
+    {
+        static_assert(std::is_trivially_destructible_v<T>);
+        return (T*)allocate(sizeof(T) * count, alignof(T));
+    }
+
+    // Frees the region of the frame before the previous one and starts
+    // allocating in it. Called by `Context::swap_buffers`.
+    void next_frame();
+
+    inline const FrameArenaStats& get_stats() const { return m_stats; }
+};
+
+// The arena of the calling thread.
+FrameArena& frame_arena();
\ No newline at end of file
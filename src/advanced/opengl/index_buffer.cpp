@@ -1,29 +1,140 @@
 #include "index_buffer.hpp"
 
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
 #include "errors.hpp"
+#include "state_cache.hpp"
+
+// Indices are narrowed a chunk at a time on the stack, so that big index
+// buffers aren't copied whole just to be uploaded.
+static const std::size_t NARROW_CHUNK_SIZE = 4096;
+
+// The buffer must be bound to `GL_ELEMENT_ARRAY_BUFFER`.
+template <typename T>
+static void upload_narrowed(const unsigned int* indices, std::size_t count)
+{
+    T chunk[NARROW_CHUNK_SIZE];
+
+    for (std::size_t first = 0; first < count; first += NARROW_CHUNK_SIZE) {
+        std::size_t chunk_count = std::min(NARROW_CHUNK_SIZE, count - first);
+        std::copy(indices + first, indices + first + chunk_count, chunk);
+
+        gl(BufferSubData, GL_ELEMENT_ARRAY_BUFFER, first * sizeof(T),
+                          chunk_count * sizeof(T), chunk);
+    }
+}
+
+IndexBuffer::IndexBuffer(const unsigned int* indices, std::size_t count, GLenum type)
+    : m_count(count), m_type(select_type(indices, count))
+{
+    if (type != GL_NONE) {
+        if (get_type_size(type) < get_type_size(m_type)) {
+            std::cerr << "WARNING: Index buffer: indices don't fit in type 0x"
+                      << std::hex << type << std::dec << ", using 0x"
+                      << std::hex << m_type << std::dec << std::endl;
+        } else {
+            m_type = type;
+        }
+    }
+
+    if (m_type == GL_UNSIGNED_INT) {
+        create(indices);
+        return;
+    }
+
+    create(nullptr);
+
+    gl_state().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+
+    if (m_type == GL_UNSIGNED_BYTE)
+        upload_narrowed<std::uint8_t>(indices, count);
+    else
+        upload_narrowed<std::uint16_t>(indices, count);
+
+    gl_count_upload(count * get_type_size(m_type));
+    gl_state().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+IndexBuffer::IndexBuffer(const void* indices, std::size_t count, GLenum type)
+    : m_count(count), m_type(type)
+{
+    create(indices);
+}
 
-IndexBuffer::IndexBuffer(const unsigned int* indices, std::size_t count)
-    : m_count(count)
+void IndexBuffer::create(const void* data)
 {
+    std::size_t size = m_count * get_type_size(m_type);
+
     gl(GenBuffers, 1, &m_ibo);
-    gl(BindBuffer, GL_ELEMENT_ARRAY_BUFFER, m_ibo);
-    gl(BufferData, GL_ELEMENT_ARRAY_BUFFER, count * sizeof(*indices), 
-                   indices, GL_STATIC_DRAW);
-    gl(BindBuffer, GL_ELEMENT_ARRAY_BUFFER, 0);
+    gl_count_names(buffers, 1);
+    gl_state().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+    gl(BufferData, GL_ELEMENT_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+
+    if (data)
+        gl_count_upload(size);
+    gl_state().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
 IndexBuffer::~IndexBuffer()
 {
-    gl(BindBuffer, GL_ELEMENT_ARRAY_BUFFER, 0);
+    // Deleting it unbinds it from the bound vertex array (and only that
+    // one, so it isn't unbound first: that would unbind whatever the
+    // bound vertex array uses instead).
+    if (!m_ibo)
+        return;
+
     gl(DeleteBuffers, 1, &m_ibo);
+    gl_count_names(buffers, -1);
+    gl_state().forget_buffer(m_ibo);
+}
+
+IndexBuffer::IndexBuffer(IndexBuffer&& other)
+    : m_ibo(std::exchange(other.m_ibo, 0)),
+      m_count(std::exchange(other.m_count, 0)),
+      m_type(other.m_type)
+{
+}
+
+IndexBuffer& IndexBuffer::operator=(IndexBuffer&& other)
+{
+    // `other` deletes what this buffer had.
+    std::swap(m_ibo, other.m_ibo);
+    std::swap(m_count, other.m_count);
+    std::swap(m_type, other.m_type);
+
+    return *this;
 }
 
 void IndexBuffer::bind() const
 {
-    gl(BindBuffer, GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+    gl_state().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
 }
 
 void IndexBuffer::unbind() const
 {
-    gl(BindBuffer, GL_ELEMENT_ARRAY_BUFFER, 0);
+    gl_state().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+std::size_t IndexBuffer::get_type_size(GLenum type)
+{
+    switch (type) {
+    case GL_UNSIGNED_BYTE:  return 1;
+    case GL_UNSIGNED_SHORT: return 2;
+    default:                return 4;
+    }
+}
+
+GLenum IndexBuffer::select_type(const unsigned int* indices, std::size_t count)
+{
+    unsigned int max = count ? *std::max_element(indices, indices + count) : 0;
+
+    if (max <= 0xff)
+        return GL_UNSIGNED_BYTE;
+    if (max <= 0xffff)
+        return GL_UNSIGNED_SHORT;
+
+    return GL_UNSIGNED_INT;
 }
\ No newline at end of file
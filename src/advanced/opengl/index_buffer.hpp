@@ -4,17 +4,39 @@
 
 #include <cstddef>
 
+// Stores the indices with the smallest type that fits the biggest one
+// (`GL_UNSIGNED_BYTE`, `GL_UNSIGNED_SHORT` or `GL_UNSIGNED_INT`), so
+// draws must use `get_type()` instead of assuming `GL_UNSIGNED_INT`.
+// Pass a `type` to force a wider one.
 class IndexBuffer {
 private:
     GLuint m_ibo;
     std::size_t m_count;
+    GLenum m_type;
+
+    // Without `data`, only allocates the storage.
+    void create(const void* data);
 
 public:
-    IndexBuffer(const unsigned int* indices, std::size_t count);
+    IndexBuffer(const unsigned int* indices, std::size_t count, GLenum type = GL_NONE);
+    // Uploads indices that are already of `type`, as they are.
+    IndexBuffer(const void* indices, std::size_t count, GLenum type);
     ~IndexBuffer();
 
+    IndexBuffer(const IndexBuffer&) = delete;
+    IndexBuffer& operator=(const IndexBuffer&) = delete;
+    // A moved-from buffer owns nothing.
+    IndexBuffer(IndexBuffer&& other);
+    IndexBuffer& operator=(IndexBuffer&& other);
+
     void bind() const;
     void unbind() const;
 
+    inline GLuint get_id() const { return m_ibo; }
     inline std::size_t get_count() const { return m_count; }
+    inline GLenum get_type() const { return m_type; }
+
+    static std::size_t get_type_size(GLenum type);
+    // The smallest type that can hold every index.
+    static GLenum select_type(const unsigned int* indices, std::size_t count);
 };
\ No newline at end of file
@@ -0,0 +1,767 @@
+#include "mesh.hpp"
+
+#include <iostream>
+#include <charconv>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <utility>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "parallel.hpp"
+
+IndexBuffer* MeshData::upload(VertexArray* va, unsigned int first_index) const
+{
+    va->bind_vertex_buffer(vertices.data(), vertices.size());
+    apply_vertex_attributes(attributes.data(), attributes.size(), stride, first_index, 0);
+
+    return va->bind_index_buffer(indices.data(), indices.size());
+}
+
+static bool same_attributes(const MeshData& a, const MeshData& b)
+{
+    return a.stride == b.stride &&
+           std::equal(a.attributes.begin(), a.attributes.end(),
+                      b.attributes.begin(), b.attributes.end(),
+                      [](const VertexAttribute& x, const VertexAttribute& y) {
+                          return x.count == y.count && x.type == y.type &&
+                                 x.normalized == y.normalized && x.offset == y.offset;
+                      });
+}
+
+bool append_mesh(MeshData& pool, const MeshData& mesh, MeshRange& range)
+{
+    if (pool.vertex_count == 0 && pool.indices.empty()) {
+        pool.attributes = mesh.attributes;
+        pool.stride = mesh.stride;
+    } else if (!same_attributes(pool, mesh)) {
+        std::cerr << "ERROR: can't append a mesh with different vertex attributes"
+                  << std::endl;
+        return false;
+    }
+
+    range.first_index = pool.indices.size();
+    range.count = mesh.indices.size();
+    range.base_vertex = pool.vertex_count;
+
+    pool.vertices.insert(pool.vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+    pool.indices.insert(pool.indices.end(), mesh.indices.begin(), mesh.indices.end());
+    pool.vertex_count += mesh.vertex_count;
+
+    return true;
+}
+
+// Flags of `ObjCorner::relative`.
+enum : unsigned char {
+    OBJ_RELATIVE_POSITION = 1,
+    OBJ_RELATIVE_TEXCOORD = 2,
+    OBJ_RELATIVE_NORMAL = 4,
+};
+
+// One corner of a face: 0-based indices into the position, texture
+// coordinate and normal lists, -1 when missing.
+struct ObjCorner {
+    int position;
+    int texcoord;
+    int normal;
+    // Until resolved, negative OBJ indices are relative to the
+    // start of their chunk (and can point before it).
+    unsigned char relative;
+
+    inline bool operator==(const ObjCorner& other) const
+    {
+        return position == other.position && texcoord == other.texcoord &&
+               normal == other.normal;
+    }
+
+    inline std::uint64_t hash() const
+    {
+        std::uint64_t hash = (std::uint64_t)(unsigned int)position * 0x9e3779b97f4a7c15ull ^
+                             (std::uint64_t)(unsigned int)texcoord * 0xc2b2ae3d27d4eb4full ^
+                             (std::uint64_t)(unsigned int)normal * 0x165667b19e3779f9ull;
+        return hash ^ (hash >> 29);
+    }
+};
+
+// Open addressing table of corners, which is much faster than a map
+// here. Stores indices into a list of distinct corners.
+class ObjCornerTable {
+private:
+    static constexpr unsigned int EMPTY = ~0u;
+
+    std::vector<unsigned int> m_slots;
+    std::size_t m_mask;
+
+public:
+    ObjCornerTable(std::size_t capacity)
+    {
+        std::size_t size = 16;
+        while (size < capacity * 2) {
+            size *= 2;
+        }
+
+        m_slots.assign(size, EMPTY);
+        m_mask = size - 1;
+    }
+
+    // Returns the index of `corner` in `corners`, adding it if needed.
+    inline unsigned int insert(const ObjCorner& corner, std::uint64_t hash,
+                               std::vector<ObjCorner>& corners)
+    {
+        std::size_t slot = hash & m_mask;
+
+        while (m_slots[slot] != EMPTY && !(corners[m_slots[slot]] == corner)) {
+            slot = (slot + 1) & m_mask;
+        }
+
+        if (m_slots[slot] == EMPTY) {
+            m_slots[slot] = corners.size();
+            corners.push_back(corner);
+        }
+
+        return m_slots[slot];
+    }
+};
+
+// The file is parsed in chunks of whole lines, one per task: the
+// elements and faces of a chunk are parsed on their own, and indices
+// are resolved once the number of elements before every chunk is known.
+struct ObjChunk {
+    const char* begin;
+    const char* end;
+
+    std::vector<float> positions;
+    std::vector<float> texcoords;
+    std::vector<float> normals;
+    // Three per triangle.
+    std::vector<ObjCorner> corners;
+
+    // Lines parsed, up to the error if any.
+    std::size_t lines;
+    const char* error;
+
+    // Elements and corners in the chunks before this one.
+    std::size_t position_base;
+    std::size_t texcoord_base;
+    std::size_t normal_base;
+    std::size_t corner_base;
+
+    // The distinct corners of the chunk, and the index of every corner
+    // in them. They are then split by shard (see `load_obj`): `shards[s]`
+    // lists the distinct corners of shard `s`.
+    std::vector<ObjCorner> unique;
+    std::vector<unsigned int> unique_indices;
+    std::vector<std::vector<unsigned int>> shards;
+    // Vertex of every distinct corner, inside its shard.
+    std::vector<unsigned int> vertices;
+    bool has_texcoords;
+    bool has_normals;
+
+    bool fail(const char* message)
+    {
+        error = message;
+        return false;
+    }
+
+    static inline const char* skip_spaces(const char* it, const char* end)
+    {
+        while (it < end && (*it == ' ' || *it == '\t' || *it == '\r')) {
+            it++;
+        }
+        return it;
+    }
+
+    bool parse_floats(const char* it, const char* end, std::vector<float>& out,
+                      std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i) {
+            it = skip_spaces(it, end);
+            if (it < end && *it == '+')
+                it++;
+
+            float value;
+            std::from_chars_result result = std::from_chars(it, end, value);
+            if (result.ec != std::errc())
+                return fail("expected a number");
+
+            out.push_back(value);
+            it = result.ptr;
+        }
+
+        return true;
+    }
+
+    // OBJ indices start at 1, and negative ones count back from
+    // the last element defined so far.
+    bool parse_index(const char*& it, const char* end, std::size_t defined, int& index,
+                     unsigned char& relative, unsigned char flag)
+    {
+        int value;
+        std::from_chars_result result = std::from_chars(it, end, value);
+        if (result.ec != std::errc() || value == 0)
+            return fail("expected an index");
+
+        it = result.ptr;
+
+        if (value < 0) {
+            index = (int)defined + value;
+            relative |= flag;
+        } else {
+            index = value - 1;
+        }
+
+        return true;
+    }
+
+    bool parse_corner(const char*& it, const char* end, ObjCorner& corner)
+    {
+        corner = { -1, -1, -1, 0 };
+
+        if (!parse_index(it, end, positions.size() / 3, corner.position,
+                         corner.relative, OBJ_RELATIVE_POSITION))
+            return false;
+
+        if (it < end && *it == '/') {
+            it++;
+
+            if (it < end && *it != '/') {
+                if (!parse_index(it, end, texcoords.size() / 2, corner.texcoord,
+                                 corner.relative, OBJ_RELATIVE_TEXCOORD))
+                    return false;
+            }
+
+            if (it < end && *it == '/') {
+                it++;
+
+                if (!parse_index(it, end, normals.size() / 3, corner.normal,
+                                 corner.relative, OBJ_RELATIVE_NORMAL))
+                    return false;
+            }
+        }
+
+        if (it < end && *it != ' ' && *it != '\t' && *it != '\r')
+            return fail("unexpected character in face");
+
+        return true;
+    }
+
+    bool parse_face(const char* it, const char* end)
+    {
+        ObjCorner first, previous, corner;
+        std::size_t count = 0;
+
+        for (it = skip_spaces(it, end); it < end; it = skip_spaces(it, end)) {
+            if (!parse_corner(it, end, corner))
+                return false;
+
+            if (count >= 2) {
+                corners.push_back(first);
+                corners.push_back(previous);
+                corners.push_back(corner);
+            }
+
+            if (count == 0)
+                first = corner;
+            previous = corner;
+            count++;
+        }
+
+        if (count < 3)
+            return fail("faces need at least 3 vertices");
+
+        return true;
+    }
+
+    bool parse_line(const char* it, const char* end)
+    {
+        it = skip_spaces(it, end);
+        if (it == end || *it == '#')
+            return true;
+
+        if (end - it > 2 && it[0] == 'v' && it[1] == ' ')
+            return parse_floats(it + 2, end, positions, 3);
+        if (end - it > 3 && it[0] == 'v' && it[1] == 't' && it[2] == ' ')
+            return parse_floats(it + 3, end, texcoords, 2);
+        if (end - it > 3 && it[0] == 'v' && it[1] == 'n' && it[2] == ' ')
+            return parse_floats(it + 3, end, normals, 3);
+        if (end - it > 2 && it[0] == 'f' && it[1] == ' ')
+            return parse_face(it + 2, end);
+
+        // Objects, groups, materials, smoothing groups...
+        return true;
+    }
+
+    void parse()
+    {
+        lines = 0;
+        error = nullptr;
+
+        for (const char* it = begin; it < end; ) {
+            lines++;
+
+            const char* line_end = (const char*)std::memchr(it, '\n', end - it);
+            if (!line_end)
+                line_end = end;
+
+            if (!parse_line(it, line_end))
+                return;
+
+            it = line_end + 1;
+        }
+    }
+
+    static inline bool resolve_index(int& index, bool relative, std::size_t base,
+                                     std::size_t total)
+    {
+        if (relative)
+            index += base;
+
+        return index < 0 ? index == -1 && !relative : (std::size_t)index < total;
+    }
+
+    // Makes the indices absolute and finds the distinct corners.
+    void resolve(std::size_t total_positions, std::size_t total_texcoords,
+                 std::size_t total_normals, std::size_t shard_count)
+    {
+        ObjCornerTable table(corners.size());
+
+        unique_indices.resize(corners.size());
+        shards.assign(shard_count, {});
+        has_texcoords = false;
+        has_normals = false;
+
+        for (std::size_t i = 0; i < corners.size(); ++i) {
+            ObjCorner& corner = corners[i];
+
+            if (!resolve_index(corner.position, corner.relative & OBJ_RELATIVE_POSITION,
+                               position_base, total_positions) ||
+                !resolve_index(corner.texcoord, corner.relative & OBJ_RELATIVE_TEXCOORD,
+                               texcoord_base, total_texcoords) ||
+                !resolve_index(corner.normal, corner.relative & OBJ_RELATIVE_NORMAL,
+                               normal_base, total_normals)) {
+                error = "index out of range";
+                return;
+            }
+
+            corner.relative = 0;
+            has_texcoords |= corner.texcoord >= 0;
+            has_normals |= corner.normal >= 0;
+
+            std::size_t count = unique.size();
+            unique_indices[i] = table.insert(corner, corner.hash(), unique);
+
+            if (unique.size() != count)
+                shards[(corner.hash() >> 32) % shard_count].push_back(count);
+        }
+
+        vertices.resize(unique.size());
+    }
+};
+
+// Maps a whole file for reading. Empty files can't be mapped,
+// they give a null `mapping`.
+static bool map_file(const std::string& path, void*& mapping, std::size_t& size)
+{
+    mapping = nullptr;
+    size = 0;
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return false;
+    }
+
+    if (info.st_size == 0) {
+        close(fd);
+        return true;
+    }
+
+    mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping keeps the file alive.
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        return false;
+    }
+
+    size = info.st_size;
+
+    // It's read once, front to back.
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    madvise(mapping, size, MADV_WILLNEED);
+
+    return true;
+}
+
+// Smaller chunks aren't worth a task.
+static const std::size_t OBJ_MIN_CHUNK_SIZE = 1 << 20;
+
+bool load_obj(const std::string& path, MeshData& mesh, unsigned int threads)
+{
+    threads = resolve_thread_count(threads);
+
+    void* mapping;
+    std::size_t size;
+    if (!map_file(path, mapping, size)) {
+        std::cerr << "ERROR: could not open mesh `" << path << "`" << std::endl;
+        return false;
+    }
+
+    const char* text = (const char*)mapping;
+
+    // A few chunks per thread, so they even out.
+    std::size_t chunk_size = std::max(OBJ_MIN_CHUNK_SIZE, size / (threads * 4) + 1);
+
+    std::vector<ObjChunk> chunks;
+    for (std::size_t offset = 0; offset < size; ) {
+        std::size_t end = std::min(size, offset + chunk_size);
+
+        const char* line_end = (const char*)std::memchr(text + end - 1, '\n', size - end + 1);
+        end = line_end ? line_end - text + 1 : size;
+
+        chunks.emplace_back();
+        chunks.back().begin = text + offset;
+        chunks.back().end = text + end;
+
+        offset = end;
+    }
+
+    parallel_for(chunks.size(), threads, [&](std::size_t i) {
+        chunks[i].parse();
+    });
+
+    std::size_t total_positions = 0;
+    std::size_t total_texcoords = 0;
+    std::size_t total_normals = 0;
+    std::size_t total_corners = 0;
+    std::size_t total_lines = 0;
+
+    for (ObjChunk& chunk : chunks) {
+        if (chunk.error) {
+            std::cerr << "ERROR: `" << path << "`:" << total_lines + chunk.lines << ": "
+                      << chunk.error << std::endl;
+            if (mapping)
+                munmap(mapping, size);
+            return false;
+        }
+
+        chunk.position_base = total_positions;
+        chunk.texcoord_base = total_texcoords;
+        chunk.normal_base = total_normals;
+        chunk.corner_base = total_corners;
+
+        total_positions += chunk.positions.size() / 3;
+        total_texcoords += chunk.texcoords.size() / 2;
+        total_normals += chunk.normals.size() / 3;
+        total_corners += chunk.corners.size();
+        total_lines += chunk.lines;
+    }
+
+    if (mapping)
+        munmap(mapping, size);
+
+    // Corners are deduplicated in each chunk, then merged into one
+    // table per shard, by hash: every shard is merged by one task
+    // without locking. With one shard, vertices come in the order
+    // the faces first use them, otherwise grouped by shard.
+    std::size_t shard_count = threads;
+
+    std::vector<float> positions(total_positions * 3);
+    std::vector<float> texcoords(total_texcoords * 2);
+    std::vector<float> normals(total_normals * 3);
+
+    parallel_for(chunks.size(), threads, [&](std::size_t i) {
+        ObjChunk& chunk = chunks[i];
+
+        std::copy(chunk.positions.begin(), chunk.positions.end(),
+                  positions.begin() + chunk.position_base * 3);
+        std::copy(chunk.texcoords.begin(), chunk.texcoords.end(),
+                  texcoords.begin() + chunk.texcoord_base * 2);
+        std::copy(chunk.normals.begin(), chunk.normals.end(),
+                  normals.begin() + chunk.normal_base * 3);
+
+        chunk.resolve(total_positions, total_texcoords, total_normals, shard_count);
+    });
+
+    bool has_texcoords = false;
+    bool has_normals = false;
+
+    for (ObjChunk& chunk : chunks) {
+        if (chunk.error) {
+            std::cerr << "ERROR: `" << path << "`: " << chunk.error << std::endl;
+            return false;
+        }
+
+        has_texcoords |= chunk.has_texcoords;
+        has_normals |= chunk.has_normals;
+    }
+
+    std::vector<std::vector<ObjCorner>> shard_vertices(shard_count);
+
+    parallel_for(shard_count, threads, [&](std::size_t s) {
+        std::size_t capacity = 0;
+        for (const ObjChunk& chunk : chunks) {
+            capacity += chunk.shards[s].size();
+        }
+
+        ObjCornerTable table(capacity);
+
+        for (ObjChunk& chunk : chunks) {
+            for (unsigned int u : chunk.shards[s]) {
+                const ObjCorner& corner = chunk.unique[u];
+                chunk.vertices[u] = table.insert(corner, corner.hash(), shard_vertices[s]);
+            }
+        }
+    });
+
+    std::vector<std::size_t> shard_base(shard_count);
+    std::size_t vertex_count = 0;
+
+    for (std::size_t s = 0; s < shard_count; ++s) {
+        shard_base[s] = vertex_count;
+        vertex_count += shard_vertices[s].size();
+    }
+
+    mesh.attributes.clear();
+    mesh.attributes.push_back({ 3, GL_FLOAT, false, 0 });
+    mesh.stride = 3 * sizeof(float);
+
+    if (has_texcoords) {
+        mesh.attributes.push_back({ 2, GL_FLOAT, false, mesh.stride });
+        mesh.stride += 2 * sizeof(float);
+    }
+
+    if (has_normals) {
+        mesh.attributes.push_back({ 3, GL_FLOAT, false, mesh.stride });
+        mesh.stride += 3 * sizeof(float);
+    }
+
+    mesh.vertex_count = vertex_count;
+    mesh.vertices.assign(vertex_count * mesh.stride, 0);
+    mesh.indices.resize(total_corners);
+
+    parallel_for(shard_count, threads, [&](std::size_t s) {
+        for (std::size_t v = 0; v < shard_vertices[s].size(); ++v) {
+            const ObjCorner& corner = shard_vertices[s][v];
+            float* out = (float*)&mesh.vertices[(shard_base[s] + v) * mesh.stride];
+
+            std::memcpy(out, &positions[corner.position * 3], 3 * sizeof(float));
+            out += 3;
+
+            if (has_texcoords) {
+                if (corner.texcoord >= 0)
+                    std::memcpy(out, &texcoords[corner.texcoord * 2], 2 * sizeof(float));
+                out += 2;
+            }
+
+            if (has_normals && corner.normal >= 0)
+                std::memcpy(out, &normals[corner.normal * 3], 3 * sizeof(float));
+        }
+    });
+
+    parallel_for(chunks.size(), threads, [&](std::size_t i) {
+        ObjChunk& chunk = chunks[i];
+
+        // The shard of every distinct corner of the chunk.
+        std::vector<unsigned int> bases(chunk.unique.size());
+        for (std::size_t s = 0; s < shard_count; ++s) {
+            for (unsigned int u : chunk.shards[s]) {
+                bases[u] = shard_base[s];
+            }
+        }
+
+        for (std::size_t c = 0; c < chunk.corners.size(); ++c) {
+            unsigned int u = chunk.unique_indices[c];
+            mesh.indices[chunk.corner_base + c] = bases[u] + chunk.vertices[u];
+        }
+    });
+
+    return true;
+}
+
+static std::size_t align_offset(std::size_t offset)
+{
+    return (offset + MESH_FILE_ALIGNMENT - 1) / MESH_FILE_ALIGNMENT * MESH_FILE_ALIGNMENT;
+}
+
+static bool write_padding(std::FILE* file, std::size_t from, std::size_t to)
+{
+    static const unsigned char zeros[MESH_FILE_ALIGNMENT] = {};
+    return std::fwrite(zeros, 1, to - from, file) == to - from;
+}
+
+bool save_mesh(const std::string& path, const MeshData& mesh)
+{
+    GLenum index_type = IndexBuffer::select_type(mesh.indices.data(), mesh.indices.size());
+    std::size_t index_size = IndexBuffer::get_type_size(index_type);
+
+    std::vector<unsigned char> indices(mesh.indices.size() * index_size);
+    for (std::size_t i = 0; i < mesh.indices.size(); ++i) {
+        unsigned int index = mesh.indices[i];
+
+        // Little endian: the low bytes come first.
+        std::memcpy(&indices[i * index_size], &index, index_size);
+    }
+
+    std::vector<MeshFileAttribute> attributes;
+    for (const VertexAttribute& attribute : mesh.attributes) {
+        attributes.push_back({ (std::uint32_t)attribute.count, attribute.type,
+                               attribute.normalized, (std::uint32_t)attribute.offset });
+    }
+
+    MeshFileHeader header = {};
+    std::memcpy(header.magic, MESH_FILE_MAGIC, sizeof(header.magic));
+    header.version = MESH_FILE_VERSION;
+    header.attribute_count = attributes.size();
+    header.stride = mesh.stride;
+    header.vertex_count = mesh.vertex_count;
+    header.index_count = mesh.indices.size();
+    header.index_type = index_type;
+
+    std::size_t attributes_end = sizeof(header) + attributes.size() * sizeof(MeshFileAttribute);
+    header.vertex_offset = align_offset(attributes_end);
+    header.index_offset = align_offset(header.vertex_offset + mesh.vertices.size());
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "ERROR: could not create mesh `" << path << "`" << std::endl;
+        return false;
+    }
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(attributes.data(), sizeof(MeshFileAttribute),
+                          attributes.size(), file) == attributes.size() &&
+              write_padding(file, attributes_end, header.vertex_offset) &&
+              std::fwrite(mesh.vertices.data(), 1, mesh.vertices.size(), file) ==
+                  mesh.vertices.size() &&
+              write_padding(file, header.vertex_offset + mesh.vertices.size(),
+                            header.index_offset) &&
+              std::fwrite(indices.data(), 1, indices.size(), file) == indices.size();
+
+    if (std::fclose(file) != 0)
+        ok = false;
+
+    if (!ok)
+        std::cerr << "ERROR: could not write mesh `" << path << "`" << std::endl;
+
+    return ok;
+}
+
+MeshFile::MeshFile(const std::string& path)
+    : m_mapping(nullptr), m_size(0), m_header(nullptr), valid(false)
+{
+    if (!map_file(path, m_mapping, m_size)) {
+        std::cerr << "ERROR: could not open mesh `" << path << "`" << std::endl;
+        return;
+    }
+
+    if (m_size < sizeof(MeshFileHeader)) {
+        std::cerr << "ERROR: `" << path << "` is not a mesh file" << std::endl;
+        return;
+    }
+
+    m_header = (const MeshFileHeader*)m_mapping;
+    valid = validate(path);
+}
+
+MeshFile::~MeshFile()
+{
+    if (m_mapping)
+        munmap(m_mapping, m_size);
+}
+
+MeshFile::MeshFile(MeshFile&& other)
+    : m_mapping(std::exchange(other.m_mapping, nullptr)),
+      m_size(std::exchange(other.m_size, 0)),
+      m_header(std::exchange(other.m_header, nullptr)),
+      m_attributes(std::move(other.m_attributes)),
+      valid(std::exchange(other.valid, false))
+{
+}
+
+MeshFile& MeshFile::operator=(MeshFile&& other)
+{
+    // `other` unmaps what this file had.
+    std::swap(m_mapping, other.m_mapping);
+    std::swap(m_size, other.m_size);
+    std::swap(m_header, other.m_header);
+    std::swap(m_attributes, other.m_attributes);
+    std::swap(valid, other.valid);
+
+    return *this;
+}
+
+bool MeshFile::validate(const std::string& path)
+{
+    if (std::memcmp(m_header->magic, MESH_FILE_MAGIC, sizeof(m_header->magic)) != 0) {
+        std::cerr << "ERROR: `" << path << "` is not a mesh file" << std::endl;
+        return false;
+    }
+
+    if (m_header->version != MESH_FILE_VERSION) {
+        std::cerr << "ERROR: `" << path << "` has version " << m_header->version
+                  << ", expected " << MESH_FILE_VERSION << std::endl;
+        return false;
+    }
+
+    std::size_t attributes_end = sizeof(MeshFileHeader) +
+                                 m_header->attribute_count * sizeof(MeshFileAttribute);
+    std::size_t index_size = IndexBuffer::get_type_size(m_header->index_type);
+
+    bool index_type_valid = m_header->index_type == GL_UNSIGNED_BYTE ||
+                            m_header->index_type == GL_UNSIGNED_SHORT ||
+                            m_header->index_type == GL_UNSIGNED_INT;
+
+    // Every size comes from the file, so they're compared by dividing
+    // what's left of it instead of multiplying and adding, which can wrap.
+    bool vertices_fit = index_type_valid && m_header->stride != 0 &&
+                        attributes_end <= m_size &&
+                        m_header->vertex_offset >= attributes_end &&
+                        m_header->vertex_offset <= m_size &&
+                        m_header->vertex_count <=
+                            (m_size - m_header->vertex_offset) / m_header->stride;
+
+    bool indices_fit = vertices_fit &&
+                       m_header->index_offset >= m_header->vertex_offset +
+                                                 m_header->vertex_count * m_header->stride &&
+                       m_header->index_offset <= m_size &&
+                       m_header->index_count <= (m_size - m_header->index_offset) / index_size;
+
+    if (!indices_fit) {
+        std::cerr << "ERROR: `" << path << "` is truncated or corrupted" << std::endl;
+        return false;
+    }
+
+    const MeshFileAttribute* attributes = (const MeshFileAttribute*)(m_header + 1);
+    for (std::uint32_t i = 0; i < m_header->attribute_count; ++i) {
+        if (attributes[i].count < 1 || attributes[i].count > 4 ||
+            attributes[i].offset >= m_header->stride) {
+            std::cerr << "ERROR: `" << path << "` is truncated or corrupted" << std::endl;
+            return false;
+        }
+
+        m_attributes.push_back({ (GLint)attributes[i].count, attributes[i].type,
+                                 attributes[i].normalized != 0, attributes[i].offset });
+    }
+
+    return true;
+}
+
+IndexBuffer* MeshFile::upload(VertexArray* va, unsigned int first_index) const
+{
+    va->bind_vertex_buffer(get_vertices(), m_header->vertex_count * m_header->stride);
+    apply_vertex_attributes(m_attributes.data(), m_attributes.size(), m_header->stride,
+                            first_index, 0);
+
+    return va->bind_index_buffer(get_indices(), m_header->index_count, m_header->index_type);
+}
\ No newline at end of file
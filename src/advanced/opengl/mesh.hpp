@@ -0,0 +1,128 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+#include "vertex_array.hpp"
+#include "vertex_layout.hpp"
+
+// An indexed mesh, with its vertices interleaved the way the GPU reads them.
+struct MeshData {
+    std::vector<unsigned char> vertices;
+    std::vector<unsigned int> indices;
+    std::vector<VertexAttribute> attributes;
+    std::size_t stride = 0;
+    std::size_t vertex_count = 0;
+
+    // Creates the buffers in `va` and sets the attributes starting at
+    // `first_index`. The vertex array must be bound.
+    IndexBuffer* upload(VertexArray* va, unsigned int first_index = 0) const;
+};
+
+// Where a mesh appended with `append_mesh` is: its indices are
+// `count` indices from `first_index`, relative to `base_vertex`.
+struct MeshRange {
+    std::size_t first_index;
+    std::size_t count;
+    int base_vertex;
+};
+
+// Appends `mesh` to `pool`, so that many meshes can share one vertex
+// array and be drawn from it (e.g. with `DrawIndirectBuffer`). Every
+// mesh must have the same attributes. Indices are kept relative to
+// their mesh, which keeps them small.
+bool append_mesh(MeshData& pool, const MeshData& mesh, MeshRange& range);
+
+// Loads the triangles of a Wavefront OBJ file (polygons are split into
+// fans, materials and groups are ignored). Every vertex has a position
+// (3 floats), then texture coordinates (2 floats) and a normal (3 floats)
+// if the file has any. The file is parsed in parallel on `threads`
+// threads (0 for one per core). With one thread, vertices are in the
+// order the faces first use them; otherwise run `optimize_vertex_fetch`
+// if that matters.
+bool load_obj(const std::string& path, MeshData& mesh, unsigned int threads = 0);
+
+// The binary mesh format (`.mesh`): a header, the attributes, then the
+// vertex and index data, each aligned to `MESH_FILE_ALIGNMENT` bytes and
+// exactly as they go to `glBufferData`. Indices are stored with the
+// smallest type that fits (see `IndexBuffer::select_type`). Everything
+// is little endian.
+const char MESH_FILE_MAGIC[4] = { 'M', 'E', 'S', 'H' };
+const std::uint32_t MESH_FILE_VERSION = 1;
+const std::size_t MESH_FILE_ALIGNMENT = 64;
+
+struct MeshFileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t attribute_count;
+    std::uint32_t stride;
+    std::uint64_t vertex_count;
+    std::uint64_t index_count;
+    // `GL_UNSIGNED_BYTE`, `GL_UNSIGNED_SHORT` or `GL_UNSIGNED_INT`.
+    std::uint32_t index_type;
+    std::uint32_t reserved;
+    // From the start of the file.
+    std::uint64_t vertex_offset;
+    std::uint64_t index_offset;
+};
+
+struct MeshFileAttribute {
+    std::uint32_t count;
+    std::uint32_t type;
+    std::uint32_t normalized;
+    std::uint32_t offset;
+};
+
+bool save_mesh(const std::string& path, const MeshData& mesh);
+
+// A `.mesh` file mapped in memory. The data is never copied: `upload`
+// hands the mapping to the driver, which reads the pages as it goes.
+class MeshFile {
+private:
+    void* m_mapping;
+    std::size_t m_size;
+
+    const MeshFileHeader* m_header;
+    std::vector<VertexAttribute> m_attributes;
+
+    bool validate(const std::string& path);
+
+public:
+    bool valid;
+
+    MeshFile(const std::string& path);
+    ~MeshFile();
+
+    MeshFile(const MeshFile&) = delete;
+    MeshFile& operator=(const MeshFile&) = delete;
+    // A moved-from mesh file maps nothing and isn't valid.
+    MeshFile(MeshFile&& other);
+    MeshFile& operator=(MeshFile&& other);
+
+    // Same as `MeshData::upload`.
+    IndexBuffer* upload(VertexArray* va, unsigned int first_index = 0) const;
+
+    inline const void* get_vertices() const
+    {
+        return (const unsigned char*)m_mapping + m_header->vertex_offset;
+    }
+
+    inline const void* get_indices() const
+    {
+        return (const unsigned char*)m_mapping + m_header->index_offset;
+    }
+
+    inline std::size_t get_vertex_count() const { return m_header->vertex_count; }
+    inline std::size_t get_index_count() const { return m_header->index_count; }
+    inline GLenum get_index_type() const { return m_header->index_type; }
+    inline std::size_t get_stride() const { return m_header->stride; }
+
+    inline const std::vector<VertexAttribute>& get_attributes() const
+    {
+        return m_attributes;
+    }
+};
\ No newline at end of file
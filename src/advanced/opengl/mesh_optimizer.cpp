@@ -0,0 +1,239 @@
+#include "mesh_optimizer.hpp"
+
+#include <iostream>
+#include <vector>
+#include <cstring>
+#include <cmath>
+
+VertexCacheStats analyze_vertex_cache(const unsigned int* indices, std::size_t index_count,
+                                      std::size_t vertex_count, std::size_t cache_size)
+{
+    // The time a vertex entered the cache. With a FIFO, a vertex is
+    // still in it if fewer than `cache_size` misses happened since.
+    std::vector<std::size_t> entered(vertex_count, 0);
+    std::size_t misses = 0;
+
+    for (std::size_t i = 0; i < index_count; ++i) {
+        unsigned int index = indices[i];
+
+        if (misses == 0 || entered[index] == 0 || misses - entered[index] >= cache_size) {
+            misses++;
+            entered[index] = misses;
+        }
+    }
+
+    VertexCacheStats stats = {};
+    if (index_count >= 3)
+        stats.acmr = (float)misses / (index_count / 3);
+    if (vertex_count != 0)
+        stats.atvr = (float)misses / vertex_count;
+
+    return stats;
+}
+
+// Scoring from the paper. The cache it models is bigger than most real
+// ones, which is what makes the order good for any size.
+static const int CACHE_SIZE = 32;
+static const float CACHE_DECAY_POWER = 1.5f;
+static const float LAST_TRIANGLE_SCORE = 0.75f;
+static const float VALENCE_BOOST_SCALE = 2.0f;
+static const float VALENCE_BOOST_POWER = 0.5f;
+
+static float vertex_score(int cache_position, unsigned int remaining_triangles)
+{
+    // Nothing left to draw with it.
+    if (remaining_triangles == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+
+    if (cache_position >= 0) {
+        // The vertices of the last triangle get a fixed score, so the
+        // next one doesn't just reuse them in the same order.
+        if (cache_position < 3) {
+            score = LAST_TRIANGLE_SCORE;
+        } else {
+            float scale = 1.0f / (CACHE_SIZE - 3);
+            score = std::pow(1.0f - (cache_position - 3) * scale, CACHE_DECAY_POWER);
+        }
+    }
+
+    // Favor vertices with few triangles left, to finish them off
+    // instead of leaving lone triangles behind.
+    score += VALENCE_BOOST_SCALE * std::pow((float)remaining_triangles, -VALENCE_BOOST_POWER);
+
+    return score;
+}
+
+void optimize_vertex_cache(unsigned int* indices, std::size_t index_count,
+                           std::size_t vertex_count)
+{
+    std::size_t triangle_count = index_count / 3;
+    if (triangle_count == 0)
+        return;
+
+    // Triangles using every vertex, as one array with an offset per vertex.
+    std::vector<unsigned int> remaining(vertex_count, 0);
+    for (std::size_t i = 0; i < triangle_count * 3; ++i) {
+        remaining[indices[i]]++;
+    }
+
+    std::vector<std::size_t> adjacency_offset(vertex_count + 1, 0);
+    for (std::size_t v = 0; v < vertex_count; ++v) {
+        adjacency_offset[v + 1] = adjacency_offset[v] + remaining[v];
+    }
+
+    std::vector<unsigned int> adjacency(triangle_count * 3);
+    std::vector<std::size_t> filled(adjacency_offset.begin(), adjacency_offset.end() - 1);
+    for (std::size_t t = 0; t < triangle_count; ++t) {
+        for (int k = 0; k < 3; ++k) {
+            adjacency[filled[indices[t * 3 + k]]++] = t;
+        }
+    }
+
+    std::vector<int> cache_position(vertex_count, -1);
+    std::vector<float> score(vertex_count);
+    for (std::size_t v = 0; v < vertex_count; ++v) {
+        score[v] = vertex_score(-1, remaining[v]);
+    }
+
+    std::vector<float> triangle_score(triangle_count);
+    std::vector<bool> emitted(triangle_count, false);
+    for (std::size_t t = 0; t < triangle_count; ++t) {
+        triangle_score[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] +
+                            score[indices[t * 3 + 2]];
+    }
+
+    std::vector<unsigned int> output;
+    output.reserve(triangle_count * 3);
+
+    std::vector<unsigned int> cache;
+    std::vector<unsigned int> new_cache;
+    cache.reserve(CACHE_SIZE + 3);
+    new_cache.reserve(CACHE_SIZE + 3);
+
+    // Only used when nothing in the cache has triangles left.
+    std::size_t next_unemitted = 0;
+
+    std::size_t best = 0;
+    for (std::size_t t = 1; t < triangle_count; ++t) {
+        if (triangle_score[t] > triangle_score[best])
+            best = t;
+    }
+
+    for (std::size_t emitted_count = 0; emitted_count < triangle_count; ++emitted_count) {
+        const unsigned int* triangle = &indices[best * 3];
+        emitted[best] = true;
+        output.insert(output.end(), triangle, triangle + 3);
+
+        // Remove the triangle from its vertices, and put them
+        // at the front of the cache.
+        new_cache.clear();
+        for (int k = 0; k < 3; ++k) {
+            unsigned int v = triangle[k];
+
+            unsigned int* begin = &adjacency[adjacency_offset[v]];
+            unsigned int* end = begin + remaining[v];
+            for (unsigned int* it = begin; it != end; ++it) {
+                if (*it == best) {
+                    *it = *(end - 1);
+                    break;
+                }
+            }
+            remaining[v]--;
+
+            new_cache.push_back(v);
+        }
+
+        for (unsigned int v : cache) {
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+                new_cache.push_back(v);
+        }
+
+        // Vertices pushed out of the cache lose their cache score.
+        for (std::size_t i = CACHE_SIZE; i < new_cache.size(); ++i) {
+            cache_position[new_cache[i]] = -1;
+            score[new_cache[i]] = vertex_score(-1, remaining[new_cache[i]]);
+        }
+
+        if (new_cache.size() > (std::size_t)CACHE_SIZE)
+            new_cache.resize(CACHE_SIZE);
+
+        std::swap(cache, new_cache);
+
+        for (std::size_t i = 0; i < cache.size(); ++i) {
+            cache_position[cache[i]] = i;
+            score[cache[i]] = vertex_score(i, remaining[cache[i]]);
+        }
+
+        // Only triangles touching the cache changed score,
+        // so the next one is picked among them.
+        float best_score = -1.0f;
+        for (unsigned int v : cache) {
+            const unsigned int* begin = &adjacency[adjacency_offset[v]];
+            for (const unsigned int* it = begin; it != begin + remaining[v]; ++it) {
+                unsigned int t = *it;
+                triangle_score[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] +
+                                    score[indices[t * 3 + 2]];
+
+                if (triangle_score[t] > best_score) {
+                    best_score = triangle_score[t];
+                    best = t;
+                }
+            }
+        }
+
+        if (best_score < 0.0f) {
+            while (next_unemitted < triangle_count && emitted[next_unemitted]) {
+                next_unemitted++;
+            }
+            best = next_unemitted;
+        }
+    }
+
+    std::memcpy(indices, output.data(), output.size() * sizeof(*indices));
+}
+
+std::size_t optimize_vertex_fetch(unsigned int* indices, std::size_t index_count,
+                                  void* vertices, std::size_t vertex_count,
+                                  std::size_t vertex_size)
+{
+    const unsigned int UNUSED = ~0u;
+
+    std::vector<unsigned int> remap(vertex_count, UNUSED);
+    unsigned int next = 0;
+
+    for (std::size_t i = 0; i < index_count; ++i) {
+        unsigned int& index = indices[i];
+
+        if (remap[index] == UNUSED)
+            remap[index] = next++;
+
+        index = remap[index];
+    }
+
+    const unsigned char* source = (const unsigned char*)vertices;
+    std::vector<unsigned char> reordered(next * vertex_size);
+
+    for (std::size_t v = 0; v < vertex_count; ++v) {
+        if (remap[v] != UNUSED)
+            std::memcpy(&reordered[remap[v] * vertex_size], source + v * vertex_size, vertex_size);
+    }
+
+    std::memcpy(vertices, reordered.data(), reordered.size());
+
+    return next;
+}
+
+void report_vertex_cache(const char* label, const unsigned int* indices,
+                         std::size_t index_count, std::size_t vertex_count)
+{
+    std::cout << "INFO: vertex cache (" << label << "):" << std::endl;
+
+    for (std::size_t cache_size : { 16, 32 }) {
+        VertexCacheStats stats = analyze_vertex_cache(indices, index_count,
+                                                      vertex_count, cache_size);
+        std::cout << " > " << cache_size << " entries: ACMR " << stats.acmr
+                  << ", ATVR " << stats.atvr << std::endl;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+
+// Offline (or load-time) reordering of indexed triangle lists, so the
+// GPU transforms fewer vertices and fetches them from fewer cache lines.
+// Run `optimize_vertex_cache` first, then `optimize_vertex_fetch`.
+
+struct VertexCacheStats {
+    // Average cache miss ratio: vertices transformed per triangle,
+    // 0.5 at best (big regular grids), 3 at worst.
+    float acmr;
+    // Average transform to vertex ratio: vertices transformed per
+    // vertex in the mesh, 1 at best.
+    float atvr;
+};
+
+// Simulates a FIFO post-transform cache of `cache_size` vertices.
+VertexCacheStats analyze_vertex_cache(const unsigned int* indices, std::size_t index_count,
+                                      std::size_t vertex_count, std::size_t cache_size = 16);
+
+// Reorders the triangles for post-transform cache hits, with Tom
+// Forsyth's "Linear-Speed Vertex Cache Optimisation". The result is
+// good for any cache size, it doesn't need to match the hardware.
+void optimize_vertex_cache(unsigned int* indices, std::size_t index_count,
+                           std::size_t vertex_count);
+
+// Reorders the vertices in the order the indices first use them (and
+// remaps the indices), so consecutive triangles read nearby memory.
+// Unused vertices are dropped; returns the new vertex count.
+std::size_t optimize_vertex_fetch(unsigned int* indices, std::size_t index_count,
+                                  void* vertices, std::size_t vertex_count,
+                                  std::size_t vertex_size);
+
+// Prints the stats before and after, with the hardware-ish cache sizes.
+void report_vertex_cache(const char* label, const unsigned int* indices,
+                         std::size_t index_count, std::size_t vertex_count);
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstddef>
+
+// Runs `task(0)` ... `task(count - 1)` on `threads` threads, the calling
+// thread included. Tasks are handed out one at a time as threads are
+// done with the previous one.
+template <typename Task>
+void parallel_for(std::size_t count, unsigned int threads, const Task& task)
+{
+    if (threads <= 1 || count <= 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    std::atomic<std::size_t> next = 0;
+    auto worker = [&]() {
+        for (std::size_t i = next++; i < count; i = next++) {
+            task(i);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < threads && i < count; ++i) {
+        workers.emplace_back(worker);
+    }
+
+    worker();
+
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+}
+
+// 0 means one thread per core.
+inline unsigned int resolve_thread_count(unsigned int threads)
+{
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+
+    return threads == 0 ? 1 : threads;
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "pool_allocator.hpp"
+
+#include <new>
+
+static BlockPool* pools = nullptr;
+
+BlockPool::BlockPool(std::size_t block_size)
+    : m_block_size(pool_block_size(block_size < sizeof(FreeBlock) ? sizeof(FreeBlock)
+                                                                   : block_size)),
+      m_free(nullptr), m_slabs(nullptr), m_stats(), m_next_pool(pools)
+{
+    pools = this;
+}
+
+BlockPool::~BlockPool()
+{
+    while (m_slabs) {
+        Slab* next = m_slabs->next;
+        ::operator delete(m_slabs);
+        m_slabs = next;
+    }
+
+    for (BlockPool** pool = &pools; *pool; pool = &(*pool)->m_next_pool) {
+        if (*pool == this) {
+            *pool = m_next_pool;
+            break;
+        }
+    }
+}
+
+void BlockPool::grow()
+{
+    // The slab header takes the place of one block, to keep them aligned.
+    unsigned char* memory = (unsigned char*)::operator new(m_block_size * (BLOCKS_PER_SLAB + 1));
+
+    Slab* slab = (Slab*)memory;
+    slab->next = m_slabs;
+    m_slabs = slab;
+
+    // Pushed backwards, so they're handed out in address order.
+    for (std::size_t i = BLOCKS_PER_SLAB; i >= 1; --i) {
+        FreeBlock* block = (FreeBlock*)(memory + i * m_block_size);
+        block->next = m_free;
+        m_free = block;
+    }
+
+    m_stats.slabs++;
+}
+
+void* BlockPool::allocate()
+{
+    if (!m_free)
+        grow();
+
+    FreeBlock* block = m_free;
+    m_free = block->next;
+
+    m_stats.allocations++;
+    m_stats.live++;
+
+    return block;
+}
+
+void BlockPool::deallocate(void* block)
+{
+    FreeBlock* free_block = (FreeBlock*)block;
+    free_block->next = m_free;
+    m_free = free_block;
+
+    m_stats.frees++;
+    m_stats.live--;
+}
+
+PoolStats block_pool_stats()
+{
+    PoolStats total = {};
+
+    for (BlockPool* pool = pools; pool; pool = pool->m_next_pool) {
+        total.allocations += pool->m_stats.allocations;
+        total.frees += pool->m_stats.frees;
+        total.live += pool->m_stats.live;
+        total.slabs += pool->m_stats.slabs;
+    }
+
+    return total;
+}
\ No newline at end of file
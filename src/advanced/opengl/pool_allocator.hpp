@@ -0,0 +1,113 @@
+#pragma once
+
+#include <memory>
+#include <cstddef>
+
+struct PoolStats {
+    // Blocks handed out and given back since the start.
+    std::size_t allocations;
+    std::size_t frees;
+    // Blocks handed out right now.
+    std::size_t live;
+    // Heap allocations made by the pool.
+    std::size_t slabs;
+};
+
+// Hands out blocks of one size, taken from slabs of `BLOCKS_PER_SLAB`
+// blocks allocated as needed. Given back blocks are kept on a free list
+// and handed out again: once a pool has grown to what a program needs,
+// it never touches the heap. Not thread safe, which is fine for the GL
+// wrappers using it: they only live on the thread the context is
+// current on.
+class BlockPool {
+public:
+    static const std::size_t BLOCKS_PER_SLAB = 64;
+    // Block sizes are rounded up to this, which is also their alignment.
+    static const std::size_t GRANULARITY = alignof(std::max_align_t);
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Slab {
+        Slab* next;
+    };
+
+    std::size_t m_block_size;
+    FreeBlock* m_free;
+    Slab* m_slabs;
+    PoolStats m_stats;
+
+    // Every pool, for `block_pool_stats`.
+    BlockPool* m_next_pool;
+
+    void grow();
+
+public:
+    BlockPool(std::size_t block_size);
+    ~BlockPool();
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    void* allocate();
+    void deallocate(void* block);
+
+    inline std::size_t get_block_size() const { return m_block_size; }
+    inline const PoolStats& get_stats() const { return m_stats; }
+
+    friend PoolStats block_pool_stats();
+};
+
+constexpr std::size_t pool_block_size(std::size_t size)
+{
+    return (size + BlockPool::GRANULARITY - 1) / BlockPool::GRANULARITY * BlockPool::GRANULARITY;
+}
+
+// The pool of `Size` byte blocks, shared by everything allocating them.
+// Never destroyed: containers destroyed at exit (e.g. in other
+// singletons) can still give their blocks back.
+template <std::size_t Size>
+BlockPool& block_pool()
+{
+    static BlockPool* pool = new BlockPool(Size);
+    return *pool;
+}
+
+// The stats of every pool added up.
+PoolStats block_pool_stats();
+
+// A standard allocator taking single objects from `block_pool`, for
+// node based containers (`std::forward_list`, `std::unordered_map`...).
+// Arrays (e.g. the buckets of a hash table) come from the heap.
+template <typename T>
+struct PoolAllocator {
+    using value_type = T;
+
+    static_assert(alignof(T) <= BlockPool::GRANULARITY);
+
+    PoolAllocator() = default;
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) {}
+
+    T* allocate(std::size_t count)
+    {
+        if (count == 1)
+            return (T*)block_pool<pool_block_size(sizeof(T))>().allocate();
+
+        return std::allocator<T>().allocate(count);
+    }
+
+    void deallocate(T* pointer, std::size_t count)
+    {
+        if (count == 1)
+            block_pool<pool_block_size(sizeof(T))>().deallocate(pointer);
+        else
+            std::allocator<T>().deallocate(pointer, count);
+    }
+
+    template <typename U>
+    inline bool operator==(const PoolAllocator<U>&) const { return true; }
+};
\ No newline at end of file
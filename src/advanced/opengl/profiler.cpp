@@ -0,0 +1,332 @@
+#include "profiler.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+
+#include "errors.hpp"
+#include "state_cache.hpp"
+
+static const char* const FRAME_SCOPE = "frame";
+
+Profiler::Profiler()
+    : m_enabled(false), m_gpu_enabled(false),
+      m_frame(0), m_frame_start(0), m_gpu_offset(0),
+      m_gpu_frames{}, m_gpu_dropped(0), m_last_gpu_frame_time(0),
+      m_state_changes_start(0), m_last_stats{},
+      m_report_interval(0), m_report_frames(0), m_report_totals{},
+      m_trace_start(0)
+{
+}
+
+Profiler::~Profiler()
+{
+    if (!m_trace_path.empty() && (!m_cpu_events.empty() || !m_frame_events.empty()))
+        write_trace();
+}
+
+double Profiler::now()
+{
+    using clock = std::chrono::steady_clock;
+    return std::chrono::duration<double>(clock::now().time_since_epoch()).count();
+}
+
+void Profiler::enable(std::size_t report_interval)
+{
+    m_enabled = true;
+    m_report_interval = report_interval;
+
+    m_gpu_enabled = GLEW_ARB_timer_query || GLEW_VERSION_3_3;
+    if (m_gpu_enabled) {
+        GLint64 timestamp;
+        gl(GetInteger64v, GL_TIMESTAMP, &timestamp);
+        m_gpu_offset = now() - timestamp * 1e-9;
+    } else {
+        std::cerr << "WARNING: timer queries are not available, "
+                  << "GPU scopes will be ignored" << std::endl;
+    }
+
+    gl_counters() = {};
+    m_state_changes_start = gl_state().get_stats().issued;
+}
+
+void Profiler::disable()
+{
+    for (GpuFrame& frame : m_gpu_frames) {
+        for (GpuQuery& query : frame.queries) {
+            gl(DeleteQueries, 1, &query.begin);
+            gl(DeleteQueries, 1, &query.end);
+        }
+
+        frame.queries.clear();
+        frame.used = 0;
+    }
+
+    m_gpu_open.clear();
+    m_enabled = false;
+    m_gpu_enabled = false;
+}
+
+void Profiler::enable_trace(const std::string& path)
+{
+    m_trace_path = path;
+    m_trace_start = now();
+}
+
+void Profiler::begin_frame()
+{
+    if (!m_enabled)
+        return;
+
+    m_frame_start = now();
+
+    // This slot was last used `GPU_LATENCY` frames ago,
+    // so its queries are most likely done by now.
+    GpuFrame& frame = m_gpu_frames[m_frame % GPU_LATENCY];
+    if (m_gpu_enabled)
+        read_gpu_frame(frame);
+
+    frame.used = 0;
+    frame.frame = m_frame;
+
+    begin_gpu_scope(FRAME_SCOPE);
+}
+
+void Profiler::end_frame()
+{
+    if (!m_enabled)
+        return;
+
+    end_gpu_scope();
+
+    double end = now();
+    add_cpu_event(FRAME_SCOPE, m_frame_start, end - m_frame_start);
+
+    std::size_t state_changes = gl_state().get_stats().issued;
+
+    const GLCounters& counters = gl_counters();
+    m_last_stats.cpu_time = end - m_frame_start;
+    m_last_stats.gpu_time = m_last_gpu_frame_time;
+    m_last_stats.draw_calls = counters.draw_calls;
+    m_last_stats.state_changes = state_changes - m_state_changes_start;
+    m_last_stats.bytes_uploaded = counters.bytes_uploaded;
+    m_last_stats.gl_calls = counters.gl_calls;
+
+    gl_counters() = {};
+    m_state_changes_start = state_changes;
+
+    if (!m_trace_path.empty())
+        m_frame_events.emplace_back(m_frame_start, m_last_stats);
+
+    m_report_totals.draw_calls += m_last_stats.draw_calls;
+    m_report_totals.state_changes += m_last_stats.state_changes;
+    m_report_totals.bytes_uploaded += m_last_stats.bytes_uploaded;
+    m_report_totals.gl_calls += m_last_stats.gl_calls;
+    m_report_frames++;
+
+    if (m_report_interval != 0 && m_report_frames >= m_report_interval)
+        report();
+
+    m_frame++;
+}
+
+void Profiler::add_cpu_event(const char* name, double start, double duration)
+{
+    if (!m_enabled)
+        return;
+
+    Summary& summary = m_cpu_summary[name];
+    summary.total += duration;
+    summary.max = std::max(summary.max, duration);
+    summary.count++;
+
+    if (!m_trace_path.empty())
+        m_cpu_events.push_back({name, start, duration});
+}
+
+void Profiler::begin_gpu_scope(const char* name)
+{
+    if (!m_gpu_enabled)
+        return;
+
+    GpuFrame& frame = m_gpu_frames[m_frame % GPU_LATENCY];
+
+    if (frame.used == frame.queries.size()) {
+        GpuQuery query = {};
+        gl(GenQueries, 1, &query.begin);
+        gl(GenQueries, 1, &query.end);
+        frame.queries.push_back(query);
+    }
+
+    GpuQuery& query = frame.queries[frame.used];
+    query.name = name;
+    query.ended = false;
+    gl(QueryCounter, query.begin, GL_TIMESTAMP);
+
+    m_gpu_open.push_back(frame.used);
+    frame.used++;
+}
+
+void Profiler::end_gpu_scope()
+{
+    if (!m_gpu_enabled || m_gpu_open.empty())
+        return;
+
+    GpuFrame& frame = m_gpu_frames[m_frame % GPU_LATENCY];
+
+    GpuQuery& query = frame.queries[m_gpu_open.back()];
+    m_gpu_open.pop_back();
+
+    gl(QueryCounter, query.end, GL_TIMESTAMP);
+    query.ended = true;
+}
+
+void Profiler::read_gpu_frame(GpuFrame& frame)
+{
+    // Checking for availability doesn't wait for the GPU,
+    // asking for results that aren't there would.
+    for (std::size_t i = 0; i < frame.used; ++i) {
+        const GpuQuery& query = frame.queries[i];
+
+        GLuint available = 0;
+        if (query.ended)
+            gl(GetQueryObjectuiv, query.end, GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if (!available) {
+            m_gpu_dropped += frame.used;
+            return;
+        }
+    }
+
+    for (std::size_t i = 0; i < frame.used; ++i) {
+        const GpuQuery& query = frame.queries[i];
+
+        GLuint64 begin, end;
+        gl(GetQueryObjectui64v, query.begin, GL_QUERY_RESULT, &begin);
+        gl(GetQueryObjectui64v, query.end, GL_QUERY_RESULT, &end);
+
+        double start = begin * 1e-9 + m_gpu_offset;
+        double duration = (end - begin) * 1e-9;
+
+        if (query.name == FRAME_SCOPE)
+            m_last_gpu_frame_time = duration;
+
+        Summary& summary = m_gpu_summary[query.name];
+        summary.total += duration;
+        summary.max = std::max(summary.max, duration);
+        summary.count++;
+
+        if (!m_trace_path.empty())
+            m_gpu_events.push_back({query.name, start, duration});
+    }
+}
+
+void Profiler::print_summaries(const char* kind,
+                               const std::unordered_map<const char*, Summary>& summaries,
+                               std::size_t frames)
+{
+    std::vector<std::pair<const char*, Summary>> sorted(summaries.begin(), summaries.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return a.second.total > b.second.total;
+    });
+
+    for (const auto& [name, summary] : sorted) {
+        std::cout << " > " << kind << " " << name << ": "
+                  << summary.total / summary.count * 1000.0 << " ms average, "
+                  << summary.max * 1000.0 << " ms max, "
+                  << (double)summary.count / frames << " per frame" << std::endl;
+    }
+}
+
+void Profiler::report()
+{
+    std::size_t frames = m_report_frames;
+
+    std::cout << "INFO: profile of frames " << m_frame + 1 - frames
+              << "-" << m_frame << std::endl;
+    std::cout << " > per frame: "
+              << m_report_totals.draw_calls / frames << " draw calls, "
+              << m_report_totals.state_changes / frames << " state changes, "
+              << m_report_totals.bytes_uploaded / frames << " bytes uploaded, "
+              << m_report_totals.gl_calls / frames << " gl calls" << std::endl;
+
+    print_summaries("cpu", m_cpu_summary, frames);
+    print_summaries("gpu", m_gpu_summary, frames);
+
+    if (m_gpu_dropped != 0)
+        std::cout << " > gpu scopes dropped: " << m_gpu_dropped << std::endl;
+
+    m_report_frames = 0;
+    m_report_totals = {};
+    m_cpu_summary.clear();
+    m_gpu_summary.clear();
+}
+
+static void write_json_string(std::ostream& stream, const char* string)
+{
+    stream << '"';
+    for (const char* c = string; *c; ++c) {
+        if (*c == '"' || *c == '\\')
+            stream << '\\';
+        stream << *c;
+    }
+    stream << '"';
+}
+
+bool Profiler::write_trace()
+{
+    std::ofstream stream(m_trace_path);
+    if (!stream) {
+        std::cerr << "ERROR: could not open trace file `"
+                  << m_trace_path << "`" << std::endl;
+        return false;
+    }
+
+    // Trace timestamps are in microseconds.
+    auto timestamp = [this](double time) {
+        return (long long)((time - m_trace_start) * 1e6);
+    };
+
+    stream << "{\"traceEvents\":[\n";
+    stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+           << "\"args\":{\"name\":\"CPU\"}},\n";
+    stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,"
+           << "\"args\":{\"name\":\"GPU\"}}";
+
+    const std::vector<Event>* tracks[] = {&m_cpu_events, &m_gpu_events};
+    for (std::size_t track = 0; track < 2; ++track) {
+        for (const Event& event : *tracks[track]) {
+            stream << ",\n{\"name\":";
+            write_json_string(stream, event.name);
+            stream << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << track + 1
+                   << ",\"ts\":" << timestamp(event.start)
+                   << ",\"dur\":" << (long long)(event.duration * 1e6) << "}";
+        }
+    }
+
+    for (const auto& [start, stats] : m_frame_events) {
+        stream << ",\n{\"name\":\"counters\",\"ph\":\"C\",\"pid\":1"
+               << ",\"ts\":" << timestamp(start)
+               << ",\"args\":{\"draw_calls\":" << stats.draw_calls
+               << ",\"state_changes\":" << stats.state_changes
+               << ",\"bytes_uploaded\":" << stats.bytes_uploaded
+               << ",\"gl_calls\":" << stats.gl_calls << "}}";
+    }
+
+    stream << "\n]}\n";
+
+    std::cout << "INFO: wrote trace to `" << m_trace_path << "`" << std::endl;
+
+    m_cpu_events.clear();
+    m_gpu_events.clear();
+    m_frame_events.clear();
+
+    return true;
+}
+
+Profiler& profiler()
+{
+    static Profiler profiler;
+    return profiler;
+}
\ No newline at end of file
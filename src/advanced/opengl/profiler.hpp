@@ -0,0 +1,162 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+
+#include "counters.hpp"
+
+// Scope names are kept as pointers, use string literals.
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#define PROFILE_SCOPE(name) \
+    ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#define PROFILE_GPU_SCOPE(name) \
+    GpuProfileScope PROFILE_CONCAT(gpu_profile_scope_, __LINE__)(name)
+
+// `gpu_time` is from `Profiler::GPU_LATENCY` frames earlier.
+struct ProfileFrameStats {
+    double cpu_time;
+    double gpu_time;
+    std::size_t draw_calls;
+    std::size_t state_changes;
+    std::size_t bytes_uploaded;
+    std::size_t gl_calls;
+};
+
+// Collects CPU and GPU scope timings and the `GLCounters` of every
+// frame. Prints a summary every `report_interval` frames and, if
+// tracing is enabled, writes everything in Chrome's trace event
+// format (open it in chrome://tracing or https://ui.perfetto.dev).
+//
+// GPU scopes are timestamp queries (so they can nest, unlike
+// `GL_TIME_ELAPSED`), read back `GPU_LATENCY` frames later so
+// reading them never stalls. Results that still aren't available
+// by then are dropped.
+//
+// Does nothing until `enable` is called, which must happen after
+// the context is created.
+class Profiler {
+public:
+    static constexpr std::size_t GPU_LATENCY = 4;
+
+private:
+    struct Event {
+        const char* name;
+        double start;
+        double duration;
+    };
+
+    struct GpuQuery {
+        const char* name;
+        GLuint begin;
+        GLuint end;
+        bool ended;
+    };
+
+    struct GpuFrame {
+        std::vector<GpuQuery> queries;
+        std::size_t used;
+        std::size_t frame;
+    };
+
+    struct Summary {
+        double total;
+        double max;
+        std::size_t count;
+    };
+
+    bool m_enabled;
+    bool m_gpu_enabled;
+
+    std::size_t m_frame;
+    double m_frame_start;
+
+    // `GL_TIMESTAMP` is in nanoseconds since some point only the
+    // driver knows, this maps it to `now()`.
+    double m_gpu_offset;
+
+    GpuFrame m_gpu_frames[GPU_LATENCY];
+    std::vector<std::size_t> m_gpu_open;
+    std::size_t m_gpu_dropped;
+    double m_last_gpu_frame_time;
+
+    std::size_t m_state_changes_start;
+    ProfileFrameStats m_last_stats;
+
+    std::size_t m_report_interval;
+    std::size_t m_report_frames;
+    ProfileFrameStats m_report_totals;
+    std::unordered_map<const char*, Summary> m_cpu_summary;
+    std::unordered_map<const char*, Summary> m_gpu_summary;
+
+    std::string m_trace_path;
+    double m_trace_start;
+    std::vector<Event> m_cpu_events;
+    std::vector<Event> m_gpu_events;
+    std::vector<std::pair<double, ProfileFrameStats>> m_frame_events;
+
+    void read_gpu_frame(GpuFrame& frame);
+    void report();
+
+    static void print_summaries(const char* kind,
+                                const std::unordered_map<const char*, Summary>& summaries,
+                                std::size_t frames);
+
+public:
+    Profiler();
+    ~Profiler();
+
+    // 0 disables the printed summary.
+    void enable(std::size_t report_interval = 120);
+    // Deletes the queries, so it must be called before the context is gone.
+    void disable();
+
+    inline bool is_enabled() const { return m_enabled; }
+
+    // Events are kept in memory until `write_trace` (or exit).
+    void enable_trace(const std::string& path);
+    bool write_trace();
+
+    void begin_frame();
+    void end_frame();
+
+    // Seconds, on the same clock as the CPU scopes.
+    static double now();
+
+    void add_cpu_event(const char* name, double start, double duration);
+
+    void begin_gpu_scope(const char* name);
+    void end_gpu_scope();
+
+    inline const ProfileFrameStats& get_last_frame_stats() const { return m_last_stats; }
+    inline std::size_t get_gpu_dropped() const { return m_gpu_dropped; }
+};
+
+Profiler& profiler();
+
+class ProfileScope {
+private:
+    const char* m_name;
+    double m_start;
+
+public:
+    inline ProfileScope(const char* name)
+        : m_name(name), m_start(profiler().is_enabled() ? Profiler::now() : 0) {}
+
+    inline ~ProfileScope()
+    {
+        if (profiler().is_enabled())
+            profiler().add_cpu_event(m_name, m_start, Profiler::now() - m_start);
+    }
+};
+
+class GpuProfileScope {
+public:
+    inline GpuProfileScope(const char* name) { profiler().begin_gpu_scope(name); }
+    inline ~GpuProfileScope() { profiler().end_gpu_scope(); }
+};
\ No newline at end of file
@@ -0,0 +1,233 @@
+#include "program_cache.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+
+#include "errors.hpp"
+
+// Bump when the layout of `EntryHeader` changes.
+static const std::uint32_t ENTRY_VERSION = 1;
+static const char ENTRY_MAGIC[8] = { 'G', 'L', 'P', 'R', 'O', 'G', 'C', 'H' };
+
+struct EntryHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t format;
+    std::uint64_t key;
+    std::uint64_t size;
+    std::uint64_t checksum;
+};
+
+// FNV-1a, good enough to tell sources apart and to catch corruption.
+static std::uint64_t hash_bytes(const void* data, std::size_t size,
+                                std::uint64_t hash = 0xcbf29ce484222325ull)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+ProgramCache& gl_program_cache()
+{
+    static ProgramCache cache;
+    return cache;
+}
+
+ProgramCache::ProgramCache()
+    : m_enabled(false)
+{
+}
+
+bool ProgramCache::enable(const std::string& directory)
+{
+    GLint formats;
+    gl(GetIntegerv, GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+
+    if (formats == 0) {
+        std::cerr << "WARNING: the driver doesn't support program binaries, "
+                  << "program cache disabled" << std::endl;
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    if (error) {
+        std::cerr << "ERROR: could not create program cache directory `"
+                  << directory << "`: " << error.message() << std::endl;
+        return false;
+    }
+
+    m_directory = directory;
+    m_driver.clear();
+
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+        const GLubyte* value;
+        gl_call(value = glGetString(name));
+
+        m_driver.append((const char*)value);
+        m_driver.append("\n");
+    }
+
+    m_enabled = true;
+
+    return true;
+}
+
+void ProgramCache::disable()
+{
+    m_enabled = false;
+}
+
+std::string ProgramCache::entry_path(std::uint64_t key) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+
+    return m_directory + "/" + name;
+}
+
+std::uint64_t ProgramCache::make_key(std::string_view sources, std::string_view defines) const
+{
+    // The separators keep e.g. ("ab", "c") and ("a", "bc") apart.
+    std::uint64_t hash = hash_bytes(sources.data(), sources.size());
+    hash = hash_bytes("\0", 1, hash);
+    hash = hash_bytes(defines.data(), defines.size(), hash);
+    hash = hash_bytes("\0", 1, hash);
+    hash = hash_bytes(m_driver.data(), m_driver.size(), hash);
+
+    return hash;
+}
+
+GLuint ProgramCache::load(std::uint64_t key)
+{
+    if (!m_enabled)
+        return 0;
+
+    std::string path = entry_path(key);
+
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream)
+        return 0;
+
+    EntryHeader header;
+    stream.read((char*)&header, sizeof(header));
+
+    bool usable = stream && 
+                  std::memcmp(header.magic, ENTRY_MAGIC, sizeof(ENTRY_MAGIC)) == 0 &&
+                  header.version == ENTRY_VERSION &&
+                  header.key == key;
+
+    // The size is checked against what's left of the file before
+    // allocating anything, a corrupt one can be anything.
+    if (usable) {
+        std::streamoff begin = stream.tellg();
+        stream.seekg(0, std::ios::end);
+        std::streamoff end = stream.tellg();
+        stream.seekg(begin);
+
+        usable = stream && begin >= 0 && end >= begin &&
+                 header.size == (std::uint64_t)(end - begin);
+    }
+
+    std::vector<char> binary;
+    if (usable) {
+        binary.resize(header.size);
+        stream.read(binary.data(), binary.size());
+
+        usable = stream && hash_bytes(binary.data(), binary.size()) == header.checksum;
+    }
+
+    stream.close();
+
+    GLuint program = 0;
+    if (usable) {
+        gl_call(program = glCreateProgram());
+        gl_count_names(programs, 1);
+        gl(ProgramBinary, program, header.format, binary.data(), binary.size());
+
+        // The driver is free to reject binaries, e.g. after an update
+        // that kept the same version string.
+        GLint status;
+        gl(GetProgramiv, program, GL_LINK_STATUS, &status);
+
+        if (status == GL_FALSE) {
+            gl(DeleteProgram, program);
+            gl_count_names(programs, -1);
+            program = 0;
+            usable = false;
+        }
+    }
+
+    if (!usable) {
+        std::cerr << "WARNING: discarding unusable program cache entry `" 
+                  << path << "`" << std::endl;
+
+        // Not being able to remove it (e.g. a read-only cache) is fine,
+        // it's discarded again next time.
+        std::error_code error;
+        std::filesystem::remove(path, error);
+    }
+
+    return program;
+}
+
+void ProgramCache::store(std::uint64_t key, GLuint program)
+{
+    if (!m_enabled)
+        return;
+
+    GLint length;
+    gl(GetProgramiv, program, GL_PROGRAM_BINARY_LENGTH, &length);
+
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+
+    GLenum format;
+    gl(GetProgramBinary, program, length, &length, &format, binary.data());
+
+    EntryHeader header;
+    std::memcpy(header.magic, ENTRY_MAGIC, sizeof(ENTRY_MAGIC));
+    header.version = ENTRY_VERSION;
+    header.format = format;
+    header.key = key;
+    header.size = length;
+    header.checksum = hash_bytes(binary.data(), length);
+
+    // Write to a temporary file and rename it, so a crash (or another
+    // process) never sees a half written entry.
+    std::string path = entry_path(key);
+    std::string temporary_path = path + ".tmp";
+
+    {
+        std::ofstream stream(temporary_path, std::ios::binary | std::ios::trunc);
+        stream.write((const char*)&header, sizeof(header));
+        stream.write(binary.data(), length);
+
+        if (!stream) {
+            std::cerr << "ERROR: could not write program cache entry `" 
+                      << temporary_path << "`" << std::endl;
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary_path, path, error);
+
+    if (error) {
+        std::cerr << "ERROR: could not write program cache entry `" 
+                  << path << "`: " << error.message() << std::endl;
+        std::filesystem::remove(temporary_path, error);
+    }
+}
\ No newline at end of file
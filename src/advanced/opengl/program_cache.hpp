@@ -0,0 +1,44 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+// On-disk cache of linked programs (`glGetProgramBinary`).
+// Entries are keyed by a hash of the shader sources, the defines and
+// the driver's vendor, renderer and version strings, so updating the
+// driver or editing a shader simply misses the cache.
+// Disabled until `enable` is called, which must happen after the
+// context is created.
+class ProgramCache {
+private:
+    std::string m_directory;
+    std::string m_driver;
+    bool m_enabled;
+
+    std::string entry_path(std::uint64_t key) const;
+
+public:
+    ProgramCache();
+
+    // Returns false (and stays disabled) if the driver
+    // doesn't support program binaries.
+    bool enable(const std::string& directory);
+    void disable();
+
+    inline bool is_enabled() const { return m_enabled; }
+
+    std::uint64_t make_key(std::string_view sources, std::string_view defines) const;
+
+    // Returns a linked program, or 0 if there's no usable entry for `key`.
+    // Corrupted or rejected entries are removed.
+    GLuint load(std::uint64_t key);
+
+    // `program` must have been linked with
+    // `GL_PROGRAM_BINARY_RETRIEVABLE_HINT` set.
+    void store(std::uint64_t key, GLuint program);
+};
+
+ProgramCache& gl_program_cache();
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "render_thread.hpp"
+
+#include <iostream>
+
+#include "errors.hpp"
+#include "frame_arena.hpp"
+#include "shader_watcher.hpp"
+
+std::atomic<int> RenderThread::s_running = 0;
+
+RenderThread::RenderThread(Context& context)
+    : m_context(context), m_recording(nullptr), m_frames_submitted(0),
+      m_frames_done(0), m_started(0)
+{
+    for (auto& buffer : m_buffers) {
+        m_free.push(&buffer);
+    }
+
+    m_context.release_current();
+    m_thread = std::thread(&RenderThread::run, this);
+
+    m_started.wait(0);
+    valid = m_started == 1;
+
+    if (!valid) {
+        m_thread.join();
+        m_context.make_current();
+        return;
+    }
+
+    s_running++;
+}
+
+RenderThread::~RenderThread()
+{
+    stop();
+}
+
+void RenderThread::run()
+{
+    bool current = m_context.make_current();
+
+    m_started = current ? 1 : -1;
+    m_started.notify_one();
+
+    if (!current)
+        return;
+
+    while (CommandBuffer* buffer = m_submitted.pop()) {
+        // Reloaded programs are swapped in here, before anything draws.
+        shader_watcher().update();
+
+        buffer->execute();
+        buffer->reset();
+
+        gl_frame_check_errors();
+        m_context.swap_buffers();
+
+        m_free.push(buffer);
+
+        m_frames_done.fetch_add(1, std::memory_order_release);
+        m_frames_done.notify_one();
+    }
+
+    m_context.release_current();
+}
+
+CommandBuffer& RenderThread::begin_frame()
+{
+    if (!m_recording) {
+        m_recording = m_free.pop();
+
+        // The buffer is free again, so the frame that last used it is
+        // done: its region of the arena can be reused.
+        frame_arena().next_frame();
+    }
+
+    return *m_recording;
+}
+
+void RenderThread::end_frame()
+{
+    m_submitted.push(&begin_frame());
+    m_recording = nullptr;
+
+    m_frames_submitted++;
+}
+
+void RenderThread::finish()
+{
+    std::size_t done = m_frames_done.load(std::memory_order_acquire);
+
+    while (done != m_frames_submitted) {
+        m_frames_done.wait(done, std::memory_order_acquire);
+        done = m_frames_done.load(std::memory_order_acquire);
+    }
+}
+
+void RenderThread::stop()
+{
+    if (!m_thread.joinable())
+        return;
+
+    m_submitted.push(nullptr);
+    m_thread.join();
+    s_running--;
+
+    m_context.make_current();
+}
\ No newline at end of file
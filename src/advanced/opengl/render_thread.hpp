@@ -0,0 +1,91 @@
+#pragma once
+
+#include <thread>
+#include <atomic>
+#include <cstddef>
+
+#include "context.hpp"
+#include "command_buffer.hpp"
+#include "spsc_queue.hpp"
+
+// Executes recorded frames on a thread of its own, which owns the GL
+// context, so the application thread can simulate and record the next
+// frame while the previous one goes through the driver:
+//
+//     RenderThread render_thread(context);
+//     while (...) {
+//         ... simulate ...
+//         CommandBuffer& frame = render_thread.begin_frame();
+//         ... record into `frame` ...
+//         render_thread.end_frame();
+//         context.poll_events();
+//     }
+//     render_thread.stop();
+//
+// There are `FRAMES_IN_FLIGHT` command buffers: one being recorded while
+// the other is executed. Frames are handed over in both directions
+// through lock-free queues, the application only waits if it's a whole
+// frame ahead. Everything else touching GL (creating and destroying
+// objects, reading back) must happen before the render thread starts or
+// after it stopped, when the context is current on the application
+// thread again. The render thread calls `shader_watcher().update()`
+// before each frame, so watched shaders are still reloaded; the
+// application must not call it while the render thread runs. Reloads
+// rewrite the uniforms of shaders, so `Shader::get_uniform` must be
+// done with before the render thread starts too (it asserts so).
+class RenderThread {
+public:
+    static const std::size_t FRAMES_IN_FLIGHT = 2;
+
+private:
+    Context& m_context;
+    std::thread m_thread;
+
+    CommandBuffer m_buffers[FRAMES_IN_FLIGHT];
+    // Recorded frames, a null pointer stops the thread.
+    SpscQueue<CommandBuffer*, FRAMES_IN_FLIGHT> m_submitted;
+    // Executed frames, ready to be recorded again.
+    SpscQueue<CommandBuffer*, FRAMES_IN_FLIGHT> m_free;
+
+    CommandBuffer* m_recording;
+    std::size_t m_frames_submitted;
+    std::atomic<std::size_t> m_frames_done;
+
+    // 0 while starting, then 1 if the context could be made current.
+    std::atomic<int> m_started;
+
+    void run();
+
+    // Render threads that are started and not stopped yet.
+    static std::atomic<int> s_running;
+
+public:
+    bool valid;
+
+    // Releases `context` on the calling thread and makes it
+    // current on the render thread.
+    RenderThread(Context& context);
+    // Same as `stop`.
+    ~RenderThread();
+
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    // Returns an empty buffer to record the next frame into. Waits if
+    // the render thread is still busy with both buffers. Starts a new
+    // frame in this thread's `frame_arena`.
+    CommandBuffer& begin_frame();
+    // Hands the frame over. It's executed, then `Context::swap_buffers`.
+    void end_frame();
+
+    // Waits until every frame handed over was swapped.
+    void finish();
+    // Finishes, stops the thread and makes the context
+    // current on the calling thread again.
+    void stop();
+
+    inline std::size_t get_frames_done() const { return m_frames_done; }
+
+    // Whether any render thread owns a context right now.
+    static inline bool any_running() { return s_running > 0; }
+};
\ No newline at end of file
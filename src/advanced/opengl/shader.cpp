@@ -1,34 +1,202 @@
 #include "shader.hpp"
 
 #include <iostream>
-#include <fstream>
 #include <string>
+#include <utility>
+#include <algorithm>
+#include <cassert>
 
 #include "errors.hpp"
+#include "state_cache.hpp"
+#include "program_cache.hpp"
+#include "uniform_buffer.hpp"
+#include "shader_source.hpp"
+#include "shader_watcher.hpp"
+#include "render_thread.hpp"
 
-int Shader::get_uniform_location(const std::string& name)
+void Shader::load_active_uniforms()
 {
-    if (m_locations.find(name) != m_locations.end()) {
-        return m_locations[name];
+    m_locations.clear();
+
+    GLint count;
+    gl(GetProgramiv, m_program, GL_ACTIVE_UNIFORMS, &count);
+
+    GLint max_length;
+    gl(GetProgramiv, m_program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+
+    std::string name(max_length, '\0');
+
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length;
+        GLint size;
+        GLenum type;
+        gl(GetActiveUniform, m_program, i, max_length, &length, &size, &type, name.data());
+
+        std::string uniform_name(name.data(), length);
+
+        GLint loc;
+        gl_call(loc = glGetUniformLocation(m_program, uniform_name.c_str()));
+
+        // Uniforms inside of uniform blocks don't have a location.
+        if (loc == -1)
+            continue;
+
+        // Arrays are reported as `name[0]`, but are usually
+        // referred to just by `name`.
+        if (uniform_name.ends_with("[0]"))
+            m_locations[uniform_name.substr(0, length - 3)] = loc;
+
+        m_locations[std::move(uniform_name)] = loc;
+    }
+}
+
+void Shader::resolve_handles()
+{
+    for (std::size_t i = 0; i < m_handle_names.size(); ++i) {
+        m_handle_locations[i] = get_uniform_location(m_handle_names[i]);
+
+        if (m_handle_locations[i] == -1) {
+            std::cerr << "WARNING: uniform `" << m_handle_names[i] << "` is not active"
+                      << std::endl;
+        }
+    }
+}
+
+int Shader::get_uniform_location(std::string_view name) const
+{
+    auto it = m_locations.find(name);
+    if (it != m_locations.end())
+        return it->second;
+
+    // Only the first element of arrays (and `name[0]`) is listed by
+    // `load_active_uniforms`, the driver knows about e.g. `name[2]` or
+    // `lights[1].color`. Misses are kept too, so they're asked about once.
+    std::string uniform_name(name);
+
+    GLint location;
+    gl_call(location = glGetUniformLocation(m_program, uniform_name.c_str()));
+
+    m_locations.emplace(std::move(uniform_name), location);
+
+    return location;
+}
+
+int Shader::get_uniform_location(UniformHandle uniform) const
+{
+    if (uniform.index < 0 || (std::size_t)uniform.index >= m_handle_locations.size())
+        return -1;
+
+    return m_handle_locations[uniform.index];
+}
+
+UniformHandle Shader::get_uniform(std::string_view name)
+{
+    // The render thread reloads shaders, which rewrites the tables below.
+    assert(!RenderThread::any_running() && "get uniforms before starting the render thread");
+
+    wait();
+
+    UniformHandle uniform;
+
+    auto it = std::find(m_handle_names.begin(), m_handle_names.end(), name);
+    if (it != m_handle_names.end()) {
+        uniform.index = it - m_handle_names.begin();
+        return uniform;
+    }
+
+    GLint location = get_uniform_location(name);
+
+    if (location == -1) {
+        std::cerr << "WARNING: uniform `" << name << "` is not active" << std::endl;
+    }
+
+    uniform.index = m_handle_names.size();
+    m_handle_names.emplace_back(name);
+    m_handle_locations.push_back(location);
+
+    return uniform;
+}
+
+// Returns the index of the block, or `GL_INVALID_INDEX` if it isn't active.
+GLuint Shader::apply_block_binding(std::string_view name, GLuint binding)
+{
+    std::string block_name(name);
+
+    GLuint index;
+    gl_call(index = glGetUniformBlockIndex(m_program, block_name.c_str()));
+
+    if (index == GL_INVALID_INDEX) {
+        std::cerr << "WARNING: uniform block `" << name << "` is not active" << std::endl;
+        return index;
+    }
+
+    gl(UniformBlockBinding, m_program, index, binding);
+
+    return index;
+}
+
+void Shader::bind_uniform_block(std::string_view name, const UniformBuffer& buffer)
+{
+    wait();
+
+    // Kept even if the block isn't active, a reload may make it active.
+    auto it = std::find_if(m_block_bindings.begin(), m_block_bindings.end(),
+                           [&](const auto& block) { return block.first == name; });
+    if (it != m_block_bindings.end())
+        it->second = buffer.get_binding();
+    else
+        m_block_bindings.emplace_back(name, buffer.get_binding());
+
+    GLuint index = apply_block_binding(name, buffer.get_binding());
+    if (index == GL_INVALID_INDEX)
+        return;
+
+    GLint size;
+    gl(GetActiveUniformBlockiv, m_program, index, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+
+    if ((std::size_t)size > buffer.get_layout().get_size()) {
+        std::cerr << "WARNING: uniform block `" << name << "` is " << size
+                  << " bytes, but its buffer only has "
+                  << buffer.get_layout().get_size() << " bytes" << std::endl;
     }
+}
 
-    GLint loc;
-    gl_call(loc = glGetUniformLocation(m_program, name.c_str()));
+// Defines go right after `#version`, which must be the first thing in a shader.
+// Returns where they go in `source`.
+static std::size_t defines_position(std::string_view source)
+{
+    std::size_t version = source.find("#version");
+    if (version == std::string_view::npos)
+        return 0;
 
-    m_locations[name] = loc;
+    std::size_t line_end = source.find('\n', version);
+    if (line_end == std::string_view::npos)
+        return source.size();
 
-    return loc;
+    return line_end + 1;
 }
 
-static GLuint compile_shader(GLenum type, const std::string& source)
+// Only starts the compilation, see `check_stage`.
+static GLuint submit_stage(GLenum type, std::string_view source, std::string_view defines)
 {
     GLuint id;
     gl_call(id = glCreateShader(type));
-    
-    const char* c_source = source.c_str();
-    gl(ShaderSource, id, 1, &c_source, nullptr);
+
+    // Pass the pieces separately instead of building a new string.
+    std::size_t split = defines_position(source);
+
+    const char* pieces[] = { source.data(), defines.data(), source.data() + split };
+    GLint lengths[] = { (GLint)split, (GLint)defines.size(), (GLint)(source.size() - split) };
+
+    gl(ShaderSource, id, 3, pieces, lengths);
     gl(CompileShader, id);
 
+    return id;
+}
+
+// Waits for the compilation to finish, if it didn't already.
+static bool check_stage(ShaderStage stage, GLuint id)
+{
     int result;
     gl(GetShaderiv, id, GL_COMPILE_STATUS, &result);
 
@@ -39,21 +207,19 @@ static GLuint compile_shader(GLenum type, const std::string& source)
         char* error = (char*)alloca(error_length);
         gl(GetShaderInfoLog, id, error_length, &error_length, error);
 
-        const char* shader_type = 
-            type == GL_VERTEX_SHADER ? "vertex" : "fragment";
-
-        std::cerr << "ERROR: " << shader_type << " shader compilation: " 
+        std::cerr << "ERROR: " << shader_stage_name(stage) << " shader compilation: " 
                   << error;
 
-        gl(DeleteShader, id);
-
-        return 0;
+        return false;
     }
 
-    return id;
+    return true;
 }
 
-Shader::Shader(const std::string& source_path)
+Shader::Shader(const std::string& source_path, const std::vector<std::string>& defines,
+               bool deferred)
+    : m_program(0), m_pending(false), m_cache_key(0), m_source_path(source_path),
+      m_watch_id(0), m_reload_program(0), m_reload_cache_key(0)
 {
     valid = true;
     
@@ -61,77 +227,354 @@ Shader::Shader(const std::string& source_path)
      *   Parse shader   *
      *                  */
     
-    std::ifstream stream(source_path);
+    ShaderSources sources;
+    if (!shader_source_loader().load(source_path, sources)) {
+        valid = false;
+        return;
+    }
+
+    for (const auto& define : defines) {
+        m_define_lines.append("#define ");
+        m_define_lines.append(define);
+        m_define_lines.append("\n");
+    }
+
+    /*                             *
+     *   Load from program cache   *
+     *                             */
+
+    ProgramCache& cache = gl_program_cache();
+
+    if (cache.is_enabled()) {
+        m_cache_key = cache.make_key(sources.text, m_define_lines);
+
+        m_program = cache.load(m_cache_key);
+        if (m_program != 0) {
+            load_active_uniforms();
+            return;
+        }
+    }
 
-    std::string vertex_source;
-    std::string fragment_source;
-    GLenum shader_mode = GL_VERTEX_SHADER;
+    /*                                    *
+     *   Submit compilation and linking   *
+     *                                    */
 
-    std::string line;
-    while (getline(stream, line)) {
-        if (line.find("#shader") != std::string::npos) {
-            if (line.find("vertex") != std::string::npos)
-                shader_mode = GL_VERTEX_SHADER;
-            else if (line.find("fragment") != std::string::npos)
-                shader_mode = GL_FRAGMENT_SHADER;
+    m_program = submit_program(sources, m_pending_stages);
+    m_pending = true;
 
+    if (!deferred)
+        wait();
+}
+
+GLuint Shader::submit_program(const ShaderSources& sources, std::vector<Stage>& stages)
+{
+    // Nothing here asks for the result, so drivers that compile
+    // in the background don't have to wait for it.
+    GLuint program;
+    gl_call(program = glCreateProgram());
+    gl_count_names(programs, 1);
+
+    for (std::size_t i = 0; i < (std::size_t)ShaderStage::Count; ++i) {
+        ShaderStage stage = (ShaderStage)i;
+        if (!sources.has(stage))
             continue;
+
+        GLuint id = submit_stage(shader_stage_type(stage), sources.get(stage), m_define_lines);
+        stages.push_back({ stage, id });
+    }
+
+    for (const auto& stage : stages) {
+        gl(AttachShader, program, stage.id);
+    }
+
+    if (gl_program_cache().is_enabled())
+        gl(ProgramParameteri, program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+    gl(LinkProgram, program);
+
+    return program;
+}
+
+bool Shader::finish_program(GLuint program, std::vector<Stage>& stages)
+{
+    bool ok = true;
+
+    for (const auto& stage : stages) {
+        if (!check_stage(stage.stage, stage.id))
+            ok = false;
+    }
+
+    if (ok) {
+        GLint linked;
+        gl(GetProgramiv, program, GL_LINK_STATUS, &linked);
+
+        if (linked == GL_FALSE) {
+            GLint error_length;
+            gl(GetProgramiv, program, GL_INFO_LOG_LENGTH, &error_length);
+
+            std::string error(error_length, '\0');
+            gl(GetProgramInfoLog, program, error_length, &error_length, error.data());
+
+            std::cerr << "ERROR: shader linking: " << error;
+
+            ok = false;
         }
+    }
+
+    // Because the program was already linked, we
+    // don't need the shaders of each stage anymore.
+    for (const auto& stage : stages) {
+        gl(DeleteShader, stage.id);
+    }
+    stages.clear();
+
+    if (!ok) {
+        delete_program(program);
+        return false;
+    }
+
+    gl(ValidateProgram, program);
+
+    return true;
+}
+
+void Shader::delete_program(GLuint program)
+{
+    gl(DeleteProgram, program);
+    gl_count_names(programs, -1);
+    gl_state().forget_program(program);
+}
+
+// Never blocks. Without KHR_parallel_shader_compile there's no way to
+// ask, so this is always true.
+static bool is_program_complete(GLuint program)
+{
+    if (!GLEW_KHR_parallel_shader_compile && !GLEW_ARB_parallel_shader_compile)
+        return true;
 
-        if (shader_mode == GL_VERTEX_SHADER) {
-            vertex_source.append(line);
-            vertex_source.append("\n");
-        } else if (shader_mode == GL_FRAGMENT_SHADER) {
-            fragment_source.append(line);
-            fragment_source.append("\n");
+    GLint completed;
+    gl(GetProgramiv, program, GL_COMPLETION_STATUS_KHR, &completed);
+
+    return completed == GL_TRUE;
+}
+
+bool Shader::is_ready() const
+{
+    if (!m_pending)
+        return true;
+
+    return is_program_complete(m_program);
+}
+
+void Shader::wait()
+{
+    if (!m_pending)
+        return;
+
+    m_pending = false;
+
+    if (!finish_program(m_program, m_pending_stages)) {
+        m_program = 0;
+        valid = false;
+        return;
+    }
+
+    ProgramCache& cache = gl_program_cache();
+    if (cache.is_enabled())
+        cache.store(m_cache_key, m_program);
+
+    load_active_uniforms();
+}
+
+void Shader::watch()
+{
+    if (m_watch_id != 0 || m_source_path.empty())
+        return;
+
+    m_watch_id = shader_watcher().watch(this, m_source_path);
+}
+
+void Shader::reload(const ShaderSources& sources)
+{
+    // A newer version replaces one that's still compiling.
+    if (m_reload_program) {
+        for (const auto& stage : m_reload_stages) {
+            gl(DeleteShader, stage.id);
         }
+        m_reload_stages.clear();
+
+        delete_program(m_reload_program);
+        m_reload_program = 0;
     }
 
-    /*                             *
-     *   Compile and link shader   *
-     *                             */
+    ProgramCache& cache = gl_program_cache();
 
-    gl_call(m_program = glCreateProgram());
+    if (cache.is_enabled()) {
+        m_reload_cache_key = cache.make_key(sources.text, m_define_lines);
 
-    GLuint vert_shader = compile_shader(GL_VERTEX_SHADER, vertex_source);
-    if (vert_shader == 0) {
-        gl(DeleteProgram, m_program);
-        valid = true;
+        m_reload_program = cache.load(m_reload_cache_key);
+        if (m_reload_program != 0)
+            return;
     }
 
-    GLuint frag_shader = compile_shader(GL_FRAGMENT_SHADER, fragment_source);
-    if (frag_shader == 0) {
-        gl(DeleteProgram, m_program);
-        valid = true;
-    }    
+    m_reload_program = submit_program(sources, m_reload_stages);
+}
+
+bool Shader::finish_reload()
+{
+    if (!m_reload_program)
+        return true;
+
+    // Loaded from the program cache if there are no stages.
+    if (!m_reload_stages.empty()) {
+        if (!is_program_complete(m_reload_program))
+            return false;
+
+        if (!finish_program(m_reload_program, m_reload_stages)) {
+            std::cerr << "WARNING: " << m_source_path << ": keeping the previous program"
+                      << std::endl;
+            m_reload_program = 0;
+            return true;
+        }
 
-    gl(AttachShader, m_program, vert_shader);
-    gl(AttachShader, m_program, frag_shader);
+        ProgramCache& cache = gl_program_cache();
+        if (cache.is_enabled())
+            cache.store(m_reload_cache_key, m_reload_program);
+    }
+
+    // Only if the file changed right after the shader was created.
+    wait();
+
+    if (m_program)
+        delete_program(m_program);
 
-    gl(LinkProgram, m_program);
-    gl(ValidateProgram, m_program);
+    m_program = std::exchange(m_reload_program, 0);
+    m_cache_key = m_reload_cache_key;
+    valid = true;
+
+    load_active_uniforms();
+    resolve_handles();
 
-    gl(DeleteShader, vert_shader);
-    gl(DeleteShader, frag_shader);
+    for (const auto& [name, binding] : m_block_bindings) {
+        apply_block_binding(name, binding);
+    }
+
+    std::cout << "INFO: reloaded " << m_source_path << std::endl;
+
+    return true;
 }
 
 Shader::~Shader()
 {
-    gl(DeleteProgram, m_program);
+    if (m_watch_id != 0)
+        shader_watcher().unwatch(m_watch_id);
+
+    // Destroyed before `wait` or before a reload was done.
+    for (const auto& stage : m_pending_stages) {
+        gl(DeleteShader, stage.id);
+    }
+
+    for (const auto& stage : m_reload_stages) {
+        gl(DeleteShader, stage.id);
+    }
+
+    if (m_reload_program)
+        delete_program(m_reload_program);
+
+    if (!m_program)
+        return;
+
+    delete_program(m_program);
+}
+
+Shader::Shader(Shader&& other)
+    : m_program(std::exchange(other.m_program, 0)),
+      m_pending(std::exchange(other.m_pending, false)),
+      m_pending_stages(std::exchange(other.m_pending_stages, {})),
+      m_cache_key(other.m_cache_key),
+      m_locations(std::move(other.m_locations)),
+      m_handle_names(std::move(other.m_handle_names)),
+      m_handle_locations(std::move(other.m_handle_locations)),
+      m_block_bindings(std::move(other.m_block_bindings)),
+      m_source_path(std::exchange(other.m_source_path, {})),
+      m_define_lines(std::move(other.m_define_lines)),
+      m_watch_id(std::exchange(other.m_watch_id, 0)),
+      m_reload_program(std::exchange(other.m_reload_program, 0)),
+      m_reload_stages(std::exchange(other.m_reload_stages, {})),
+      m_reload_cache_key(other.m_reload_cache_key),
+      valid(std::exchange(other.valid, false))
+{
+    if (m_watch_id != 0)
+        shader_watcher().retarget(m_watch_id, this);
+}
+
+Shader& Shader::operator=(Shader&& other)
+{
+    // `other` deletes what this shader had.
+    std::swap(m_program, other.m_program);
+    std::swap(m_pending, other.m_pending);
+    std::swap(m_pending_stages, other.m_pending_stages);
+    std::swap(m_cache_key, other.m_cache_key);
+    std::swap(m_locations, other.m_locations);
+    std::swap(m_handle_names, other.m_handle_names);
+    std::swap(m_handle_locations, other.m_handle_locations);
+    std::swap(m_block_bindings, other.m_block_bindings);
+    std::swap(m_source_path, other.m_source_path);
+    std::swap(m_define_lines, other.m_define_lines);
+    std::swap(m_watch_id, other.m_watch_id);
+    std::swap(m_reload_program, other.m_reload_program);
+    std::swap(m_reload_stages, other.m_reload_stages);
+    std::swap(m_reload_cache_key, other.m_reload_cache_key);
+    std::swap(valid, other.valid);
+
+    if (m_watch_id != 0)
+        shader_watcher().retarget(m_watch_id, this);
+    if (other.m_watch_id != 0)
+        shader_watcher().retarget(other.m_watch_id, &other);
+
+    return *this;
+}
+
+void Shader::set_uniform_1f(std::string_view name, float x)
+{
+    glUniform1f(get_uniform_location(name), x);
+}
+
+void Shader::set_uniform_1f(UniformHandle uniform, float x)
+{
+    glUniform1f(get_uniform_location(uniform), x);
 }
 
-void Shader::set_uniform_4f(const std::string& name, 
+void Shader::set_uniform_2f(std::string_view name, float x, float y)
+{
+    glUniform2f(get_uniform_location(name), x, y);
+}
+
+void Shader::set_uniform_2f(UniformHandle uniform, float x, float y)
+{
+    glUniform2f(get_uniform_location(uniform), x, y);
+}
+
+void Shader::set_uniform_4f(std::string_view name, 
                             float x, float y, float z, float w)
 {
     glUniform4f(get_uniform_location(name), x, y, z, w);
 }
 
-void Shader::bind() const
+void Shader::set_uniform_4f(UniformHandle uniform, 
+                            float x, float y, float z, float w)
 {
-    gl(UseProgram, m_program);
+    glUniform4f(get_uniform_location(uniform), x, y, z, w);
+}
+
+void Shader::bind()
+{
+    wait();
+
+    gl_state().use_program(m_program);
 }
 
 void Shader::unbind() const
 {
-    gl(UseProgram, 0);
+    gl_state().use_program(0);
 }
\ No newline at end of file
@@ -1,27 +1,159 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <vector>
 #include <unordered_map>
+#include <functional>
+#include <utility>
+#include <cstdint>
 
 #include <GL/glew.h>
 
+#include "shader_source.hpp"
+
+class UniformBuffer;
+class ShaderWatcher;
+
+// A uniform resolved once with `Shader::get_uniform`, so setting it
+// every frame doesn't need a name lookup. It indexes the locations
+// kept by the shader, which are resolved again when it's reloaded,
+// so it stays valid. Only use it with the shader it came from. Setting
+// a default constructed (invalid) handle does nothing.
+struct UniformHandle {
+    int index = -1;
+
+    inline bool valid() const { return index != -1; }
+};
+
 class Shader {
 private:
+    // Lets `m_locations` be searched with a `std::string_view`
+    // without building a temporary `std::string`.
+    struct NameHash {
+        using is_transparent = void;
+
+        inline std::size_t operator()(std::string_view name) const
+        {
+            return std::hash<std::string_view>{}(name);
+        }
+    };
+
+    struct Stage {
+        ShaderStage stage;
+        GLuint id;
+    };
+
     GLuint m_program;
 
-    std::unordered_map<std::string, int> m_locations;
+    // Set while the program is compiling and linking.
+    bool m_pending;
+    std::vector<Stage> m_pending_stages;
+    std::uint64_t m_cache_key;
+
+    // Filled by `load_active_uniforms`, and by `get_uniform_location`
+    // with the names it had to ask the driver about.
+    mutable std::unordered_map<std::string, int, NameHash, std::equal_to<>> m_locations;
+
+    // Indexed by `UniformHandle::index`.
+    std::vector<std::string> m_handle_names;
+    std::vector<GLint> m_handle_locations;
+
+    // Uniform block bindings, set again on new programs.
+    std::vector<std::pair<std::string, GLuint>> m_block_bindings;
+
+    // What the program was made from, to reload it.
+    std::string m_source_path;
+    std::string m_define_lines;
+
+    // Set by `watch`, see `ShaderWatcher`.
+    std::uint64_t m_watch_id;
+    // A reloaded program still compiling, `m_program` stays in use until
+    // it's done. Left at 0 if the reload failed.
+    GLuint m_reload_program;
+    std::vector<Stage> m_reload_stages;
+    std::uint64_t m_reload_cache_key;
 
-    int get_uniform_location(const std::string& name);
+    friend class ShaderWatcher;
+
+    // Starts compiling and linking `sources` into a new program.
+    GLuint submit_program(const ShaderSources& sources, std::vector<Stage>& stages);
+    // Waits for `program` and deletes its stages. If it didn't compile
+    // or link, prints why, deletes it and returns false.
+    static bool finish_program(GLuint program, std::vector<Stage>& stages);
+    static void delete_program(GLuint program);
+
+    void load_active_uniforms();
+    void resolve_handles();
+    GLuint apply_block_binding(std::string_view name, GLuint binding);
+    int get_uniform_location(std::string_view name) const;
+    // -1 (ignored by `glUniform*`) for an invalid handle.
+    int get_uniform_location(UniformHandle uniform) const;
+
+    // Called by `ShaderWatcher` on the render thread. `reload` submits the
+    // new sources and `finish_reload` swaps the programs once the new one
+    // is ready, it returns false while it's still compiling.
+    void reload(const ShaderSources& sources);
+    bool finish_reload();
 
 public:
+    // For deferred shaders, compilation and linking errors
+    // are only known after `wait`.
     bool valid;
 
-    void bind() const;
+    // Waits for the program to be ready the first time.
+    void bind();
     void unbind() const;
 
-    void set_uniform_4f(const std::string& name, 
+    // Never blocks. Without KHR_parallel_shader_compile there's no way to
+    // ask, so this is always true and `wait` compiles synchronously.
+    bool is_ready() const;
+    // Blocks until the program is compiled and linked.
+    void wait();
+
+    // The program in use, it changes when the shader is reloaded.
+    inline GLuint get_id() const { return m_program; }
+
+    // Returns the same handle for the same name. A uniform that isn't
+    // active still gets a handle (setting it does nothing), it may be
+    // after a reload. Not while a `RenderThread` runs, see there.
+    UniformHandle get_uniform(std::string_view name);
+
+    // Connects the uniform block `name` to the binding point of `buffer`.
+    // Only needs to be done once (reloads keep it), the buffer contents
+    // can then be updated without touching the shader.
+    void bind_uniform_block(std::string_view name, const UniformBuffer& buffer);
+
+    // Reloads the shader when its file, or a file it includes, changes
+    // on disk (see `ShaderWatcher`). The new program replaces the old one
+    // in `shader_watcher().update()`, the old one is kept if the new one
+    // doesn't compile. Uniform values aren't carried over.
+    void watch();
+
+    void set_uniform_1f(std::string_view name, float x);
+    void set_uniform_1f(UniformHandle uniform, float x);
+
+    void set_uniform_2f(std::string_view name, float x, float y);
+    void set_uniform_2f(UniformHandle uniform, float x, float y);
+
+    void set_uniform_4f(std::string_view name, 
+                        float x, float y, float z, float w);
+    void set_uniform_4f(UniformHandle uniform, 
                         float x, float y, float z, float w);
 
-    Shader(const std::string& source_path);
+    // `source_path` is read with `shader_source_loader()`, every stage in it
+    // is compiled. Every define (e.g. "USE_FOG" or "LIGHT_COUNT 4") is added
+    // as a `#define` to all stages.
+    // Deferred shaders return as soon as compilation and linking are
+    // submitted, so many of them can be compiled in parallel
+    // (see `ShaderLibrary`).
+    Shader(const std::string& source_path, const std::vector<std::string>& defines = {},
+           bool deferred = false);
     ~Shader();
+
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+    // A moved-from shader has no program and isn't valid.
+    Shader(Shader&& other);
+    Shader& operator=(Shader&& other);
 };
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "shader_library.hpp"
+
+#include <iostream>
+#include <algorithm>
+
+#include "errors.hpp"
+
+ShaderLibrary::ShaderLibrary()
+{
+    m_parallel = GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile;
+
+    // 0xFFFFFFFF lets the driver pick as many threads as it likes.
+    if (GLEW_KHR_parallel_shader_compile) {
+        gl(MaxShaderCompilerThreadsKHR, 0xFFFFFFFF);
+    } else if (GLEW_ARB_parallel_shader_compile) {
+        gl(MaxShaderCompilerThreadsARB, 0xFFFFFFFF);
+    }
+}
+
+Shader* ShaderLibrary::add(const std::string& name, const std::string& source_path,
+                           const std::vector<std::string>& defines)
+{
+    if (m_shaders.find(name) != m_shaders.end()) {
+        std::cerr << "ERROR: shader `" << name << "` already exists" << std::endl;
+        return nullptr;
+    }
+
+    Shader* shader = &m_shaders.try_emplace(name, source_path, defines, true).first->second;
+    m_pending.push_back(shader);
+
+    return shader;
+}
+
+Shader* ShaderLibrary::get(const std::string& name)
+{
+    auto it = m_shaders.find(name);
+    if (it == m_shaders.end())
+        return nullptr;
+
+    return &it->second;
+}
+
+std::size_t ShaderLibrary::poll()
+{
+    auto done = std::remove_if(m_pending.begin(), m_pending.end(), [](Shader* shader) {
+        if (!shader->is_ready())
+            return false;
+
+        shader->wait();
+        return true;
+    });
+
+    m_pending.erase(done, m_pending.end());
+
+    return m_pending.size();
+}
+
+void ShaderLibrary::wait_all()
+{
+    for (auto* shader : m_pending) {
+        shader->wait();
+    }
+
+    m_pending.clear();
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+
+#include "shader.hpp"
+
+// Owns a set of named shaders that are compiled together.
+// Every shader is submitted to the driver as soon as it's added,
+// without waiting for the result, so drivers supporting
+// KHR_parallel_shader_compile compile them on all cores.
+// A shader only blocks the first time it's bound, if it isn't done yet.
+class ShaderLibrary {
+private:
+    // Nodes of an `unordered_map` never move, so
+    // pointers to the shaders stay valid.
+    std::unordered_map<std::string, Shader> m_shaders;
+    std::vector<Shader*> m_pending;
+
+    bool m_parallel;
+
+public:
+    ShaderLibrary();
+
+    Shader* add(const std::string& name, const std::string& source_path,
+                const std::vector<std::string>& defines = {});
+
+    // Returns nullptr if there's no shader called `name`.
+    Shader* get(const std::string& name);
+
+    // Finishes the shaders that are done compiling and returns how
+    // many are still compiling. Never blocks on the driver.
+    std::size_t poll();
+
+    // Blocks until every shader is done.
+    void wait_all();
+
+    // Whether the driver compiles in the background.
+    inline bool is_parallel() const { return m_parallel; }
+};
\ No newline at end of file
@@ -0,0 +1,264 @@
+#include "shader_source.hpp"
+
+#include <iostream>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+
+struct StageInfo {
+    ShaderStage stage;
+    GLenum type;
+    const char* name;
+};
+
+static const StageInfo STAGES[] = {
+    { ShaderStage::Vertex,         GL_VERTEX_SHADER,          "vertex" },
+    { ShaderStage::Fragment,       GL_FRAGMENT_SHADER,        "fragment" },
+    { ShaderStage::Geometry,       GL_GEOMETRY_SHADER,        "geometry" },
+    { ShaderStage::Compute,        GL_COMPUTE_SHADER,         "compute" },
+    { ShaderStage::TessControl,    GL_TESS_CONTROL_SHADER,    "tess_control" },
+    { ShaderStage::TessEvaluation, GL_TESS_EVALUATION_SHADER, "tess_evaluation" },
+};
+
+GLenum shader_stage_type(ShaderStage stage)
+{
+    return STAGES[(std::size_t)stage].type;
+}
+
+const char* shader_stage_name(ShaderStage stage)
+{
+    return STAGES[(std::size_t)stage].name;
+}
+
+ShaderSourceLoader& shader_source_loader()
+{
+    static ShaderSourceLoader loader;
+    return loader;
+}
+
+static bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static std::string_view trim(std::string_view text)
+{
+    while (!text.empty() && is_space(text.front()))
+        text.remove_prefix(1);
+
+    while (!text.empty() && is_space(text.back()))
+        text.remove_suffix(1);
+
+    return text;
+}
+
+// If `line` is `#<directive> <argument>`, returns the trimmed argument.
+static bool match_directive(std::string_view line, std::string_view directive,
+                            std::string_view& argument)
+{
+    line = trim(line);
+
+    if (line.size() < directive.size() + 1 || line[0] != '#')
+        return false;
+
+    if (line.substr(1, directive.size()) != directive)
+        return false;
+
+    std::string_view rest = line.substr(1 + directive.size());
+    if (!rest.empty() && !is_space(rest[0]))
+        return false;
+
+    argument = trim(rest);
+
+    return true;
+}
+
+// Calls `f(line, line_begin)` for every line of `text`, without the newline.
+template <typename F>
+static bool for_each_line(std::string_view text, F&& f)
+{
+    std::size_t begin = 0;
+
+    while (begin < text.size()) {
+        const char* newline = (const char*)std::memchr(text.data() + begin, '\n', 
+                                                       text.size() - begin);
+        std::size_t end = newline ? newline - text.data() : text.size();
+
+        if (!f(text.substr(begin, end - begin), begin))
+            return false;
+
+        begin = end + 1;
+    }
+
+    return true;
+}
+
+const std::string* ShaderSourceLoader::read_file(const std::string& path)
+{
+    auto it = m_files.find(path);
+    if (it != m_files.end())
+        return &it->second;
+
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        std::cerr << "ERROR: could not open shader `" << path << "`" << std::endl;
+        return nullptr;
+    }
+
+    std::fseek(file, 0, SEEK_END);
+    long size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+
+    std::string contents;
+    if (size > 0) {
+        contents.resize(size);
+
+        if (std::fread(contents.data(), 1, size, file) != (std::size_t)size) {
+            std::cerr << "ERROR: could not read shader `" << path << "`" << std::endl;
+            std::fclose(file);
+            return nullptr;
+        }
+    }
+
+    std::fclose(file);
+
+    return &(m_files[path] = std::move(contents));
+}
+
+bool ShaderSourceLoader::expand(const std::string& path, std::string& text,
+                                std::vector<std::string>& include_stack,
+                                std::vector<std::string>* files)
+{
+    if (std::find(include_stack.begin(), include_stack.end(), path) != include_stack.end()) {
+        std::cerr << "ERROR: `" << path << "` includes itself" << std::endl;
+        return false;
+    }
+
+    const std::string* contents = read_file(path);
+    if (!contents)
+        return false;
+
+    if (files && std::find(files->begin(), files->end(), path) == files->end())
+        files->push_back(path);
+
+    // Most files don't include anything, skip the scan for them.
+    if (contents->find("#include") == std::string::npos) {
+        text.append(*contents);
+        return true;
+    }
+
+    include_stack.push_back(path);
+
+    std::filesystem::path directory = std::filesystem::path(path).parent_path();
+    std::string_view source = *contents;
+    std::size_t copied = 0;
+
+    bool ok = for_each_line(source, [&](std::string_view line, std::size_t begin) {
+        std::string_view argument;
+        if (!match_directive(line, "include", argument))
+            return true;
+
+        if (argument.size() < 2 || argument.front() != '"' || argument.back() != '"') {
+            std::cerr << "ERROR: " << path << ": expected `#include \"path\"`" << std::endl;
+            return false;
+        }
+
+        std::string_view include = argument.substr(1, argument.size() - 2);
+        std::string include_path = (directory / include).lexically_normal().string();
+
+        text.append(source.substr(copied, begin - copied));
+
+        // The cache never moves its strings, so `source`
+        // stays valid while included files are added to it.
+        if (!expand(include_path, text, include_stack, files))
+            return false;
+
+        if (text.empty() || text.back() != '\n')
+            text.push_back('\n');
+
+        copied = std::min(source.size(), begin + line.size() + 1);
+
+        return true;
+    });
+
+    include_stack.pop_back();
+
+    if (!ok)
+        return false;
+
+    text.append(source.substr(copied));
+
+    return true;
+}
+
+bool ShaderSourceLoader::load(const std::string& path, ShaderSources& sources,
+                              std::vector<std::string>* files)
+{
+    sources.text.clear();
+    for (auto& stage : sources.stages) {
+        stage = {};
+    }
+
+    std::vector<std::string> include_stack;
+    if (!expand(path, sources.text, include_stack, files))
+        return false;
+
+    std::string_view text = sources.text;
+
+    // Beginning of the current stage, if any.
+    int current = -1;
+    std::size_t stage_begin = 0;
+
+    auto close_stage = [&](std::size_t end) {
+        if (current != -1)
+            sources.stages[current] = text.substr(stage_begin, end - stage_begin);
+    };
+
+    bool ok = for_each_line(text, [&](std::string_view line, std::size_t begin) {
+        std::string_view argument;
+        if (!match_directive(line, "shader", argument))
+            return true;
+
+        close_stage(begin);
+
+        current = -1;
+        for (const auto& info : STAGES) {
+            if (argument == info.name)
+                current = (int)info.stage;
+        }
+
+        if (current == -1) {
+            std::cerr << "ERROR: " << path << ": unknown shader stage `" 
+                      << argument << "`" << std::endl;
+            return false;
+        }
+
+        if (!sources.stages[current].empty()) {
+            std::cerr << "ERROR: " << path << ": " << argument 
+                      << " stage declared twice" << std::endl;
+            return false;
+        }
+
+        stage_begin = std::min(text.size(), begin + line.size() + 1);
+
+        return true;
+    });
+
+    if (!ok)
+        return false;
+
+    close_stage(text.size());
+
+    return true;
+}
+
+void ShaderSourceLoader::invalidate(const std::string& path)
+{
+    m_files.erase(path);
+}
+
+void ShaderSourceLoader::clear_cache()
+{
+    m_files.clear();
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <cstddef>
+
+enum class ShaderStage {
+    Vertex,
+    Fragment,
+    Geometry,
+    Compute,
+    TessControl,
+    TessEvaluation,
+    Count,
+};
+
+GLenum shader_stage_type(ShaderStage stage);
+// Name used after `#shader` (e.g. "tess_control").
+const char* shader_stage_name(ShaderStage stage);
+
+// Sources of every stage of a `#shader` file.
+// The stage views point into `text`, so they're only valid
+// while it's alive and unchanged.
+struct ShaderSources {
+    std::string text;
+    std::string_view stages[(std::size_t)ShaderStage::Count];
+
+    inline std::string_view get(ShaderStage stage) const { return stages[(std::size_t)stage]; }
+    inline bool has(ShaderStage stage) const { return !get(stage).empty(); }
+};
+
+// Reads shader files made of sections starting with `#shader <stage>`
+// (anything before the first one is ignored).
+// `#include "path"` lines are replaced by the contents of `path`,
+// relative to the file including it. Files are read once and kept
+// in a cache, so shared includes are only read from disk once.
+class ShaderSourceLoader {
+private:
+    std::unordered_map<std::string, std::string> m_files;
+
+    const std::string* read_file(const std::string& path);
+    bool expand(const std::string& path, std::string& text,
+                std::vector<std::string>& include_stack, std::vector<std::string>* files);
+
+public:
+    // Returns false (and prints why) if a file can't be read
+    // or the file isn't well formed. Every file read (`path` and what it
+    // includes) is added to `files`, if given.
+    bool load(const std::string& path, ShaderSources& sources,
+              std::vector<std::string>* files = nullptr);
+
+    // Forgets a file (e.g. after it changed on disk).
+    void invalidate(const std::string& path);
+    void clear_cache();
+};
+
+ShaderSourceLoader& shader_source_loader();
\ No newline at end of file
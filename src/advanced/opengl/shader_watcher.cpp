@@ -0,0 +1,326 @@
+#include "shader_watcher.hpp"
+
+#include <iostream>
+#include <filesystem>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#include "shader.hpp"
+
+// How long nothing must change before shaders are read again: editors
+// and tools often write a file (or several files) in a few steps.
+static const int RELOAD_DELAY_MS = 50;
+
+ShaderWatcher& shader_watcher()
+{
+    static ShaderWatcher watcher;
+    return watcher;
+}
+
+static std::string normalize_path(const std::string& path)
+{
+    return std::filesystem::path(path).lexically_normal().string();
+}
+
+ShaderWatcher::ShaderWatcher()
+    : m_inotify(-1), m_wake(-1), m_stop(false), m_next_id(1)
+{
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+    if (!m_thread.joinable())
+        return;
+
+    m_stop = true;
+    wake();
+    m_thread.join();
+
+#ifdef __linux__
+    close(m_wake);
+    close(m_inotify);
+#endif
+}
+
+#ifdef __linux__
+
+bool ShaderWatcher::start()
+{
+    m_inotify = inotify_init1(IN_CLOEXEC);
+    if (m_inotify < 0) {
+        std::cerr << "ERROR: could not watch shaders: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    m_wake = eventfd(0, EFD_CLOEXEC);
+    if (m_wake < 0) {
+        std::cerr << "ERROR: could not watch shaders: " << std::strerror(errno) << std::endl;
+        close(m_inotify);
+        return false;
+    }
+
+    m_thread = std::thread(&ShaderWatcher::run, this);
+
+    return true;
+}
+
+void ShaderWatcher::wake()
+{
+    std::uint64_t value = 1;
+    if (write(m_wake, &value, sizeof(value)) != sizeof(value)) {
+        std::cerr << "ERROR: could not wake the shader watcher: " << std::strerror(errno)
+                  << std::endl;
+    }
+}
+
+void ShaderWatcher::run()
+{
+    // The global loader isn't thread safe. This one forgets every file
+    // that changes, so its cache is always up to date.
+    ShaderSourceLoader loader;
+    std::vector<std::string> changed;
+    bool pending = false;
+
+    alignas(inotify_event) char buffer[4096];
+
+    while (!m_stop) {
+        pollfd fds[2] = {
+            { m_inotify, POLLIN, 0 },
+            { m_wake,    POLLIN, 0 },
+        };
+
+        int result = poll(fds, 2, pending ? RELOAD_DELAY_MS : -1);
+
+        if (result < 0) {
+            if (errno == EINTR)
+                continue;
+
+            std::cerr << "ERROR: could not wait for shader changes: " << std::strerror(errno)
+                      << std::endl;
+            return;
+        }
+
+        if (result == 0) {
+            scan(loader, changed);
+            pending = false;
+            continue;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            std::uint64_t value;
+            if (read(m_wake, &value, sizeof(value)) == sizeof(value))
+                pending = true;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            ssize_t length = read(m_inotify, buffer, sizeof(buffer));
+
+            std::lock_guard lock(m_mutex);
+
+            for (ssize_t offset = 0; offset < length;) {
+                const inotify_event* event = (const inotify_event*)(buffer + offset);
+                offset += sizeof(inotify_event) + event->len;
+
+                auto it = m_directories.find(event->wd);
+                if (event->len == 0 || it == m_directories.end())
+                    continue;
+
+                std::filesystem::path path = std::filesystem::path(it->second) / event->name;
+                changed.push_back(path.lexically_normal().string());
+            }
+
+            pending = true;
+        }
+    }
+}
+
+void ShaderWatcher::scan(ShaderSourceLoader& loader, std::vector<std::string>& changed)
+{
+    struct Job {
+        std::uint64_t id;
+        std::string source_path;
+        // Otherwise only its files are needed.
+        bool reload;
+    };
+
+    std::vector<Job> jobs;
+
+    {
+        std::lock_guard lock(m_mutex);
+
+        for (const auto& [id, entry] : m_entries) {
+            bool is_new = std::find(m_new.begin(), m_new.end(), id) != m_new.end();
+
+            bool affected = std::any_of(entry.files.begin(), entry.files.end(),
+                                        [&](const std::string& file) {
+                return std::find(changed.begin(), changed.end(), file) != changed.end();
+            });
+
+            if (is_new || affected)
+                jobs.push_back({ id, entry.source_path, affected });
+        }
+
+        m_new.clear();
+    }
+
+    for (const auto& path : changed) {
+        loader.invalidate(path);
+    }
+    changed.clear();
+
+    for (const Job& job : jobs) {
+        auto sources = std::make_unique<ShaderSources>();
+        std::vector<std::string> files;
+
+        bool ok = loader.load(job.source_path, *sources, &files);
+
+        // Whatever could be read is watched even if the shader is
+        // broken, so that fixing it reloads it.
+        files.push_back(job.source_path);
+        for (auto& file : files) {
+            file = normalize_path(file);
+        }
+        std::sort(files.begin(), files.end());
+        files.erase(std::unique(files.begin(), files.end()), files.end());
+
+        std::lock_guard lock(m_mutex);
+
+        auto it = m_entries.find(job.id);
+        if (it == m_entries.end())
+            continue;
+
+        // Editors either write files in place or replace them (`IN_MOVED_TO`),
+        // only a watch on the directory sees both.
+        for (const auto& file : files) {
+            std::string directory = std::filesystem::path(file).parent_path().string();
+            if (directory.empty())
+                directory = ".";
+
+            int wd = inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (wd < 0) {
+                std::cerr << "WARNING: could not watch `" << directory << "`: "
+                          << std::strerror(errno) << std::endl;
+                continue;
+            }
+
+            m_directories[wd] = directory;
+        }
+
+        it->second.files = std::move(files);
+
+        if (!job.reload)
+            continue;
+
+        if (ok) {
+            m_ready.push_back({ job.id, std::move(sources) });
+        } else {
+            std::cerr << "WARNING: " << job.source_path << ": keeping the previous program"
+                      << std::endl;
+        }
+    }
+}
+
+#else
+
+bool ShaderWatcher::start()
+{
+    std::cerr << "WARNING: shader hot reload is only available on Linux" << std::endl;
+    return false;
+}
+
+void ShaderWatcher::wake()
+{
+}
+
+void ShaderWatcher::run()
+{
+}
+
+void ShaderWatcher::scan(ShaderSourceLoader&, std::vector<std::string>&)
+{
+}
+
+#endif
+
+std::uint64_t ShaderWatcher::watch(Shader* shader, const std::string& source_path)
+{
+    if (!m_thread.joinable() && !start())
+        return 0;
+
+    std::uint64_t id;
+
+    {
+        std::lock_guard lock(m_mutex);
+
+        id = m_next_id++;
+        m_entries[id] = { shader, source_path, { normalize_path(source_path) } };
+        m_new.push_back(id);
+    }
+
+    // Its includes are found on the thread.
+    wake();
+
+    return id;
+}
+
+void ShaderWatcher::unwatch(std::uint64_t id)
+{
+    std::lock_guard lock(m_mutex);
+
+    m_entries.erase(id);
+}
+
+void ShaderWatcher::retarget(std::uint64_t id, Shader* shader)
+{
+    std::lock_guard lock(m_mutex);
+
+    auto it = m_entries.find(id);
+    if (it != m_entries.end())
+        it->second.shader = shader;
+}
+
+Shader* ShaderWatcher::find(std::uint64_t id)
+{
+    std::lock_guard lock(m_mutex);
+
+    auto it = m_entries.find(id);
+    if (it == m_entries.end())
+        return nullptr;
+
+    return it->second.shader;
+}
+
+void ShaderWatcher::update()
+{
+    std::vector<Reload> ready;
+
+    {
+        std::lock_guard lock(m_mutex);
+        ready.swap(m_ready);
+    }
+
+    for (const Reload& reload : ready) {
+        Shader* shader = find(reload.id);
+        if (!shader)
+            continue;
+
+        shader->reload(*reload.sources);
+
+        if (std::find(m_reloading.begin(), m_reloading.end(), reload.id) == m_reloading.end())
+            m_reloading.push_back(reload.id);
+    }
+
+    // Programs still compiling are checked again on the next update.
+    std::erase_if(m_reloading, [&](std::uint64_t id) {
+        Shader* shader = find(id);
+        return !shader || shader->finish_reload();
+    });
+}
\ No newline at end of file
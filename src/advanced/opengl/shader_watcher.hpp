@@ -0,0 +1,84 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+#include "shader_source.hpp"
+
+class Shader;
+
+// Reloads shaders (see `Shader::watch`) when their files change on disk.
+// Files are watched with inotify, and read and parsed on a background
+// thread with its own `ShaderSourceLoader`. The render thread only
+// submits the new sources to the driver in `update`, and swaps the
+// programs in a later `update` once they're done compiling, so with
+// KHR_parallel_shader_compile a reload never stalls a frame.
+// Only available on Linux, elsewhere `watch` just prints a warning.
+class ShaderWatcher {
+private:
+    struct Entry {
+        Shader* shader;
+        std::string source_path;
+        // Every file the shader is made of, `#include`s too.
+        std::vector<std::string> files;
+    };
+
+    struct Reload {
+        std::uint64_t id;
+        // Can't be moved: its views point into its own text.
+        std::unique_ptr<ShaderSources> sources;
+    };
+
+    int m_inotify;
+    // An eventfd waking the thread up, to read new shaders or to stop.
+    int m_wake;
+    std::thread m_thread;
+    std::atomic<bool> m_stop;
+
+    // Everything below is shared with the thread.
+    std::mutex m_mutex;
+    std::unordered_map<std::uint64_t, Entry> m_entries;
+    std::uint64_t m_next_id;
+    // Inotify watch descriptor -> directory.
+    std::unordered_map<int, std::string> m_directories;
+    // Shaders whose files aren't known yet.
+    std::vector<std::uint64_t> m_new;
+    std::vector<Reload> m_ready;
+
+    // Only used by the render thread.
+    std::vector<std::uint64_t> m_reloading;
+
+    bool start();
+    void wake();
+    void run();
+    void scan(ShaderSourceLoader& loader, std::vector<std::string>& changed);
+    Shader* find(std::uint64_t id);
+
+public:
+    ShaderWatcher();
+    ~ShaderWatcher();
+
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+    // Used by `Shader`, returns the id of the entry.
+    std::uint64_t watch(Shader* shader, const std::string& source_path);
+    void unwatch(std::uint64_t id);
+    // After the shader was moved.
+    void retarget(std::uint64_t id, Shader* shader);
+
+    // Must be called on the render thread, at a frame boundary (e.g. before
+    // drawing anything). Never blocks on the driver.
+    void update();
+
+    // How many reloads were submitted and are still compiling.
+    inline std::size_t get_reloading() const { return m_reloading.size(); }
+};
+
+ShaderWatcher& shader_watcher();
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// A bounded lock-free queue for exactly one producer thread and one
+// consumer thread. `try_push` and `try_pop` never block; `push` and
+// `pop` sleep (with `std::atomic::wait`, not a lock) while the queue
+// is full or empty.
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+private:
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "capacity must be a power of two");
+
+    // Only ever grow, the slot is the index modulo `Capacity`. On their
+    // own cache lines so the two threads don't fight over them.
+    alignas(64) std::atomic<std::size_t> m_head;  // Written by the consumer.
+    alignas(64) std::atomic<std::size_t> m_tail;  // Written by the producer.
+
+    T m_items[Capacity];
+
+public:
+    SpscQueue() : m_head(0), m_tail(0) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer only.
+    bool try_push(const T& item)
+    {
+        std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == Capacity)
+            return false;
+
+        m_items[tail % Capacity] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        m_tail.notify_one();
+
+        return true;
+    }
+
+    void push(const T& item)
+    {
+        while (!try_push(item)) {
+            std::size_t head = m_head.load(std::memory_order_acquire);
+            if (m_tail.load(std::memory_order_relaxed) - head == Capacity)
+                m_head.wait(head, std::memory_order_acquire);
+        }
+    }
+
+    // Consumer only.
+    bool try_pop(T& item)
+    {
+        std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (m_tail.load(std::memory_order_acquire) == head)
+            return false;
+
+        item = m_items[head % Capacity];
+        m_head.store(head + 1, std::memory_order_release);
+        m_head.notify_one();
+
+        return true;
+    }
+
+    T pop()
+    {
+        T item;
+
+        while (!try_pop(item)) {
+            std::size_t tail = m_tail.load(std::memory_order_acquire);
+            if (tail == m_head.load(std::memory_order_relaxed))
+                m_tail.wait(tail, std::memory_order_acquire);
+        }
+
+        return item;
+    }
+};
\ No newline at end of file
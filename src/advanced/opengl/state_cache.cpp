@@ -0,0 +1,281 @@
+#include "state_cache.hpp"
+
+#include <iostream>
+
+#include "errors.hpp"
+
+struct Target {
+    GLenum target;
+    GLenum binding;
+};
+
+static const Target BUFFER_TARGETS[GLStateCache::BUFFER_TARGET_COUNT] = {
+    { GL_ARRAY_BUFFER,             GL_ARRAY_BUFFER_BINDING },
+    { GL_UNIFORM_BUFFER,           GL_UNIFORM_BUFFER_BINDING },
+    { GL_SHADER_STORAGE_BUFFER,    GL_SHADER_STORAGE_BUFFER_BINDING },
+    { GL_DRAW_INDIRECT_BUFFER,     GL_DRAW_INDIRECT_BUFFER_BINDING },
+    { GL_DISPATCH_INDIRECT_BUFFER, GL_DISPATCH_INDIRECT_BUFFER_BINDING },
+    { GL_COPY_READ_BUFFER,         GL_COPY_READ_BUFFER_BINDING },
+    { GL_COPY_WRITE_BUFFER,        GL_COPY_WRITE_BUFFER_BINDING },
+    { GL_PIXEL_PACK_BUFFER,        GL_PIXEL_PACK_BUFFER_BINDING },
+    { GL_PIXEL_UNPACK_BUFFER,      GL_PIXEL_UNPACK_BUFFER_BINDING },
+    { GL_TEXTURE_BUFFER,           GL_TEXTURE_BUFFER_BINDING },
+};
+
+static const Target TEXTURE_TARGETS[GLStateCache::TEXTURE_TARGET_COUNT] = {
+    { GL_TEXTURE_1D,             GL_TEXTURE_BINDING_1D },
+    { GL_TEXTURE_2D,             GL_TEXTURE_BINDING_2D },
+    { GL_TEXTURE_3D,             GL_TEXTURE_BINDING_3D },
+    { GL_TEXTURE_1D_ARRAY,       GL_TEXTURE_BINDING_1D_ARRAY },
+    { GL_TEXTURE_2D_ARRAY,       GL_TEXTURE_BINDING_2D_ARRAY },
+    { GL_TEXTURE_RECTANGLE,      GL_TEXTURE_BINDING_RECTANGLE },
+    { GL_TEXTURE_CUBE_MAP,       GL_TEXTURE_BINDING_CUBE_MAP },
+    { GL_TEXTURE_2D_MULTISAMPLE, GL_TEXTURE_BINDING_2D_MULTISAMPLE },
+    { GL_TEXTURE_BUFFER,         GL_TEXTURE_BINDING_BUFFER },
+};
+
+template <std::size_t N>
+static int target_index(const Target (&targets)[N], GLenum target)
+{
+    for (std::size_t i = 0; i < N; ++i) {
+        if (targets[i].target == target)
+            return i;
+    }
+
+    return -1;
+}
+
+GLStateCache& gl_state()
+{
+    static GLStateCache cache;
+    return cache;
+}
+
+GLStateCache::GLStateCache()
+    : m_stats()
+{
+    invalidate();
+}
+
+bool GLStateCache::changed(GLuint& cached, GLuint value)
+{
+    if (cached == value) {
+        m_stats.skipped++;
+        return false;
+    }
+
+    cached = value;
+    m_stats.issued++;
+
+    return true;
+}
+
+void GLStateCache::check() const
+{
+#ifdef GL_STATE_CACHE_VALIDATE
+    validate();
+#endif
+}
+
+void GLStateCache::use_program(GLuint program)
+{
+    if (changed(m_program, program))
+        gl(UseProgram, program);
+
+    check();
+}
+
+void GLStateCache::bind_vertex_array(GLuint vertex_array)
+{
+    if (changed(m_vertex_array, vertex_array))
+        gl(BindVertexArray, vertex_array);
+
+    check();
+}
+
+void GLStateCache::bind_buffer(GLenum target, GLuint buffer)
+{
+    GLuint* cached = nullptr;
+
+    if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        if (m_vertex_array != UNKNOWN) {
+            // `operator[]` starts unknown vertex arrays at 0, which is
+            // wrong, so insert them as unknown first.
+            auto it = m_element_buffers.try_emplace(m_vertex_array, UNKNOWN).first;
+            cached = &it->second;
+        }
+    } else {
+        int index = target_index(BUFFER_TARGETS, target);
+        if (index != -1)
+            cached = &m_buffers[index];
+    }
+
+    if (!cached) {
+        m_stats.issued++;
+        gl(BindBuffer, target, buffer);
+    } else if (changed(*cached, buffer)) {
+        gl(BindBuffer, target, buffer);
+    }
+
+    check();
+}
+
+void GLStateCache::bind_buffer_base(GLenum target, GLuint index, GLuint buffer)
+{
+    // Indexed bindings aren't cached, they're set rarely.
+    m_stats.issued++;
+    gl(BindBufferBase, target, index, buffer);
+
+    int target_id = target_index(BUFFER_TARGETS, target);
+    if (target_id != -1)
+        m_buffers[target_id] = buffer;
+
+    check();
+}
+
+void GLStateCache::bind_texture(GLuint unit, GLenum target, GLuint texture)
+{
+    int index = target_index(TEXTURE_TARGETS, target);
+
+    if (unit >= MAX_TEXTURE_UNITS || index == -1) {
+        m_stats.issued += 2;
+        m_active_texture_unit = unit;
+        gl(ActiveTexture, GL_TEXTURE0 + unit);
+        gl(BindTexture, target, texture);
+        return;
+    }
+
+    if (m_textures[unit][index] == texture) {
+        m_stats.skipped++;
+        return;
+    }
+
+    if (changed(m_active_texture_unit, unit))
+        gl(ActiveTexture, GL_TEXTURE0 + unit);
+
+    m_textures[unit][index] = texture;
+    m_stats.issued++;
+    gl(BindTexture, target, texture);
+
+    check();
+}
+
+void GLStateCache::forget_program(GLuint program)
+{
+    // A program in use is only deleted once it's not in use anymore,
+    // and its name can be reused by then.
+    if (m_program == program)
+        m_program = UNKNOWN;
+}
+
+void GLStateCache::forget_vertex_array(GLuint vertex_array)
+{
+    if (m_vertex_array == vertex_array)
+        m_vertex_array = 0;
+
+    m_element_buffers.erase(vertex_array);
+}
+
+void GLStateCache::forget_buffer(GLuint buffer)
+{
+    for (GLuint& cached : m_buffers) {
+        if (cached == buffer)
+            cached = 0;
+    }
+
+    // Deleting a buffer only unbinds it from the bound vertex array.
+    auto it = m_element_buffers.find(m_vertex_array);
+    if (it != m_element_buffers.end() && it->second == buffer)
+        it->second = 0;
+}
+
+void GLStateCache::forget_texture(GLuint texture)
+{
+    for (auto& unit : m_textures) {
+        for (GLuint& cached : unit) {
+            if (cached == texture)
+                cached = 0;
+        }
+    }
+}
+
+void GLStateCache::invalidate()
+{
+    m_program = UNKNOWN;
+    m_vertex_array = UNKNOWN;
+    m_active_texture_unit = UNKNOWN;
+
+    for (GLuint& cached : m_buffers) {
+        cached = UNKNOWN;
+    }
+
+    for (auto& unit : m_textures) {
+        for (GLuint& cached : unit) {
+            cached = UNKNOWN;
+        }
+    }
+
+    m_element_buffers.clear();
+}
+
+static bool validate_binding(const char* what, GLenum binding, GLuint cached)
+{
+    if (cached == GLStateCache::UNKNOWN)
+        return true;
+
+    GLint actual;
+    glGetIntegerv(binding, &actual);
+
+    if ((GLuint)actual != cached) {
+        std::cerr << "ERROR: state cache: " << what << " is " << actual
+                  << ", but the cache has " << cached << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool GLStateCache::validate() const
+{
+    bool valid = true;
+
+    valid &= validate_binding("program", GL_CURRENT_PROGRAM, m_program);
+    valid &= validate_binding("vertex array", GL_VERTEX_ARRAY_BINDING, m_vertex_array);
+
+    for (std::size_t i = 0; i < BUFFER_TARGET_COUNT; ++i) {
+        valid &= validate_binding("buffer", BUFFER_TARGETS[i].binding, m_buffers[i]);
+    }
+
+    auto it = m_element_buffers.find(m_vertex_array);
+    if (it != m_element_buffers.end()) {
+        valid &= validate_binding("element array buffer", 
+                                  GL_ELEMENT_ARRAY_BUFFER_BINDING, it->second);
+    }
+
+    GLint active_texture;
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &active_texture);
+
+    if (m_active_texture_unit != UNKNOWN && 
+        (GLuint)active_texture != GL_TEXTURE0 + m_active_texture_unit) {
+        std::cerr << "ERROR: state cache: active texture unit is " 
+                  << active_texture - GL_TEXTURE0 << ", but the cache has "
+                  << m_active_texture_unit << std::endl;
+        valid = false;
+    }
+
+    GLint texture_units;
+    glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &texture_units);
+
+    for (std::size_t unit = 0; unit < MAX_TEXTURE_UNITS && (GLint)unit < texture_units; ++unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+
+        for (std::size_t i = 0; i < TEXTURE_TARGET_COUNT; ++i) {
+            valid &= validate_binding("texture", TEXTURE_TARGETS[i].binding, 
+                                      m_textures[unit][i]);
+        }
+    }
+
+    glActiveTexture(active_texture);
+
+    return valid;
+}
\ No newline at end of file
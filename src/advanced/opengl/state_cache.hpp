@@ -0,0 +1,78 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <unordered_map>
+#include <cstddef>
+
+#include "pool_allocator.hpp"
+
+// Build with `-DGL_STATE_CACHE_VALIDATE` to compare the cache
+// against `glGet*` after every change (slow, for debugging only).
+
+struct GLStateStats {
+    std::size_t issued;
+    std::size_t skipped;
+};
+
+// Remembers what is bound to the current context and skips
+// binds that wouldn't change anything.
+// Everything in `opengl/` binds through it; if something else
+// binds behind its back, call `invalidate`.
+class GLStateCache {
+public:
+    static constexpr GLuint UNKNOWN = ~0u;
+    static constexpr std::size_t MAX_TEXTURE_UNITS = 32;
+    static constexpr std::size_t BUFFER_TARGET_COUNT = 10;
+    static constexpr std::size_t TEXTURE_TARGET_COUNT = 9;
+
+private:
+    GLuint m_program;
+    GLuint m_vertex_array;
+
+    GLuint m_buffers[BUFFER_TARGET_COUNT];
+
+    // The element array buffer binding is part of the vertex
+    // array state, so it's tracked for each vertex array. The nodes come
+    // from a pool, vertex arrays are created and deleted all the time.
+    std::unordered_map<GLuint, GLuint, std::hash<GLuint>, std::equal_to<GLuint>,
+                       PoolAllocator<std::pair<const GLuint, GLuint>>> m_element_buffers;
+
+    GLuint m_active_texture_unit;
+    GLuint m_textures[MAX_TEXTURE_UNITS][TEXTURE_TARGET_COUNT];
+
+    GLStateStats m_stats;
+
+    bool changed(GLuint& cached, GLuint value);
+    void check() const;
+
+public:
+    GLStateCache();
+
+    void use_program(GLuint program);
+    void bind_vertex_array(GLuint vertex_array);
+    void bind_buffer(GLenum target, GLuint buffer);
+    // Also changes the generic binding of `target`, like GL does.
+    void bind_buffer_base(GLenum target, GLuint index, GLuint buffer);
+    void bind_texture(GLuint unit, GLenum target, GLuint texture);
+
+    // Deleting an object unbinds it, these keep the cache in sync.
+    // Must be called right after the `glDelete*`.
+    void forget_program(GLuint program);
+    void forget_vertex_array(GLuint vertex_array);
+    void forget_buffer(GLuint buffer);
+    void forget_texture(GLuint texture);
+
+    // Forgets everything, the next bind of every kind will be issued.
+    void invalidate();
+
+    // Compares the cache with what GL reports,
+    // returns false (and prints why) if they differ.
+    bool validate() const;
+
+    inline const GLStateStats& get_stats() const { return m_stats; }
+    inline void reset_stats() { m_stats = {}; }
+};
+
+// The cache of the current context.
+GLStateCache& gl_state();
\ No newline at end of file
@@ -0,0 +1,197 @@
+#include "streaming_vertex_buffer.hpp"
+
+#include <iostream>
+#include <utility>
+
+#include "errors.hpp"
+#include "state_cache.hpp"
+
+StreamingVertexBuffer::StreamingVertexBuffer(std::size_t region_size, 
+                                             std::size_t region_count,
+                                             bool persistent)
+    : m_region_size(region_size), m_region_count(region_count),
+      m_region(0), m_used(0),
+      m_fences(region_count, nullptr),
+      m_persistent(persistent && GLEW_ARB_buffer_storage),
+      m_mapping(nullptr),
+      m_stalls(0)
+{
+    std::size_t size = m_region_size * m_region_count;
+
+    gl(GenBuffers, 1, &m_vbo);
+    gl_count_names(buffers, 1);
+    gl_state().bind_buffer(GL_ARRAY_BUFFER, m_vbo);
+
+    if (m_persistent) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        gl(BufferStorage, GL_ARRAY_BUFFER, size, nullptr, flags);
+        gl_call(m_mapping = (unsigned char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+
+        if (!m_mapping) {
+            std::cerr << "WARNING: could not map streaming vertex buffer, "
+                      << "mapping every allocation instead" << std::endl;
+
+            // Storage made with `glBufferStorage` can't be respecified,
+            // the buffer is created again.
+            gl(DeleteBuffers, 1, &m_vbo);
+            gl_state().forget_buffer(m_vbo);
+            gl(GenBuffers, 1, &m_vbo);
+            gl_state().bind_buffer(GL_ARRAY_BUFFER, m_vbo);
+
+            m_persistent = false;
+        }
+    }
+
+    if (!m_persistent)
+        gl(BufferData, GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+
+    gl_state().bind_buffer(GL_ARRAY_BUFFER, 0);
+}
+
+StreamingVertexBuffer::~StreamingVertexBuffer()
+{
+    if (!m_vbo)
+        return;
+
+    for (GLsync fence : m_fences) {
+        if (fence)
+            gl(DeleteSync, fence);
+    }
+
+    if (m_mapping) {
+        gl_state().bind_buffer(GL_ARRAY_BUFFER, m_vbo);
+        gl(UnmapBuffer, GL_ARRAY_BUFFER);
+        gl_state().bind_buffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    gl(DeleteBuffers, 1, &m_vbo);
+    gl_count_names(buffers, -1);
+    gl_state().forget_buffer(m_vbo);
+}
+
+StreamingVertexBuffer::StreamingVertexBuffer(StreamingVertexBuffer&& other)
+    : m_vbo(std::exchange(other.m_vbo, 0)),
+      m_region_size(other.m_region_size), m_region_count(other.m_region_count),
+      m_region(other.m_region), m_used(other.m_used),
+      m_fences(std::move(other.m_fences)),
+      m_persistent(other.m_persistent),
+      m_mapping(std::exchange(other.m_mapping, nullptr)),
+      m_stalls(other.m_stalls)
+{
+}
+
+StreamingVertexBuffer& StreamingVertexBuffer::operator=(StreamingVertexBuffer&& other)
+{
+    // `other` deletes what this buffer had.
+    std::swap(m_vbo, other.m_vbo);
+    std::swap(m_region_size, other.m_region_size);
+    std::swap(m_region_count, other.m_region_count);
+    std::swap(m_region, other.m_region);
+    std::swap(m_used, other.m_used);
+    std::swap(m_fences, other.m_fences);
+    std::swap(m_persistent, other.m_persistent);
+    std::swap(m_mapping, other.m_mapping);
+    std::swap(m_stalls, other.m_stalls);
+
+    return *this;
+}
+
+void StreamingVertexBuffer::bind() const
+{
+    gl_state().bind_buffer(GL_ARRAY_BUFFER, m_vbo);
+}
+
+void StreamingVertexBuffer::unbind() const
+{
+    gl_state().bind_buffer(GL_ARRAY_BUFFER, 0);
+}
+
+void StreamingVertexBuffer::set_attribute_layout(int index, int component_count, 
+                                                 GLenum component_type,
+                                                 bool normalized, std::size_t stride, 
+                                                 std::size_t offset, unsigned int divisor)
+{
+    gl(VertexAttribPointer, index, component_count, component_type, 
+                            normalized, stride, (void*)offset);
+    gl(EnableVertexAttribArray, index);
+
+    gl(VertexAttribDivisor, index, divisor);
+}
+
+void StreamingVertexBuffer::begin_frame()
+{
+    GLsync& fence = m_fences[m_region];
+    m_used = 0;
+
+    if (!fence)
+        return;
+
+    GLenum result;
+    gl_call(result = glClientWaitSync(fence, 0, 0));
+
+    if (result == GL_TIMEOUT_EXPIRED) {
+        m_stalls++;
+
+        do {
+            gl_call(result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 
+                                              1000000000));
+        } while (result == GL_TIMEOUT_EXPIRED);
+    }
+
+    if (result == GL_WAIT_FAILED) {
+        std::cerr << "ERROR: waiting for streaming vertex buffer fence failed" << std::endl;
+    }
+
+    gl(DeleteSync, fence);
+    fence = nullptr;
+}
+
+void* StreamingVertexBuffer::map(std::size_t size, std::size_t alignment, std::size_t& offset)
+{
+    std::size_t region_begin = m_region * m_region_size;
+
+    // Offsets must be aligned in the whole buffer, not just in the region.
+    std::size_t begin = region_begin + m_used;
+    begin = (begin + alignment - 1) / alignment * alignment;
+
+    if (begin + size > region_begin + m_region_size) {
+        std::cerr << "ERROR: streaming vertex buffer region is full ("
+                  << m_region_size << " bytes)" << std::endl;
+        return nullptr;
+    }
+
+    m_used = begin + size - region_begin;
+    offset = begin;
+
+    // Whatever gets written into the mapping ends up on the GPU.
+    gl_count_upload(size);
+
+    if (m_persistent)
+        return m_mapping + begin;
+
+    // The fence in `begin_frame` already guarantees the GPU is
+    // done with this range, so the driver doesn't need to sync.
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | 
+                       GL_MAP_INVALIDATE_RANGE_BIT;
+
+    void* pointer;
+    gl_call(pointer = glMapBufferRange(GL_ARRAY_BUFFER, begin, size, flags));
+
+    return pointer;
+}
+
+void StreamingVertexBuffer::unmap()
+{
+    if (m_persistent)
+        return;
+
+    gl(UnmapBuffer, GL_ARRAY_BUFFER);
+}
+
+void StreamingVertexBuffer::end_frame()
+{
+    gl_call(m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+
+    m_region = (m_region + 1) % m_region_count;
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+#include <cstddef>
+
+#include "vertex_layout.hpp"
+
+// A vertex buffer meant to be rewritten every frame.
+// The buffer is a ring of `region_count` regions of `region_size` bytes,
+// one per frame in flight. Each region is guarded by a fence, so the CPU
+// only waits for the GPU if it gets `region_count` frames ahead of it.
+//
+// Uses a persistent, coherent mapping (`glBufferStorage`) when available,
+// otherwise (or if that mapping fails) maps every allocation with
+// `glMapBufferRange` unsynchronized.
+class StreamingVertexBuffer {
+private:
+    GLuint m_vbo;
+
+    std::size_t m_region_size;
+    std::size_t m_region_count;
+
+    std::size_t m_region;
+    std::size_t m_used;
+
+    std::vector<GLsync> m_fences;
+
+    bool m_persistent;
+    unsigned char* m_mapping;
+
+    std::size_t m_stalls;
+
+public:
+    StreamingVertexBuffer(std::size_t region_size, std::size_t region_count = 3,
+                          bool persistent = true);
+    ~StreamingVertexBuffer();
+
+    StreamingVertexBuffer(const StreamingVertexBuffer&) = delete;
+    StreamingVertexBuffer& operator=(const StreamingVertexBuffer&) = delete;
+    // A moved-from buffer owns nothing.
+    StreamingVertexBuffer(StreamingVertexBuffer&& other);
+    StreamingVertexBuffer& operator=(StreamingVertexBuffer&& other);
+
+    void bind() const;
+    void unbind() const;
+
+    void set_attribute_layout(int index, int component_count, GLenum component_type,
+                              bool normalized, std::size_t stride, 
+                              std::size_t offset, unsigned int divisor = 0);
+
+    // Sets every attribute of `Layout`, starting at `first_index`.
+    // The vertex array and the buffer must be bound.
+    template <typename Layout>
+    inline void set_layout(unsigned int first_index = 0, unsigned int divisor = 0)
+    {
+        Layout::apply(first_index, divisor);
+    }
+
+    // Waits until the GPU is done reading the next region.
+    // Must be called once per frame, before any `map`.
+    void begin_frame();
+
+    // Reserves `size` bytes in the current region and returns a pointer
+    // to write them, or nullptr if the region is full. `offset` is set to
+    // the offset of the reservation in the buffer, aligned to `alignment`
+    // (pass the vertex stride to draw with `offset / stride` as first vertex).
+    // The buffer must be bound.
+    void* map(std::size_t size, std::size_t alignment, std::size_t& offset);
+
+    // Must be called after writing to a pointer returned by `map`,
+    // before drawing from it. The buffer must be bound.
+    void unmap();
+
+    // Guards the current region with a fence and moves to the next one.
+    // Must be called once per frame, after the last draw reading from it.
+    void end_frame();
+
+    inline GLuint get_id() const { return m_vbo; }
+    inline bool is_persistent() const { return m_persistent; }
+    inline std::size_t get_region_size() const { return m_region_size; }
+
+    // Number of times `begin_frame` had to wait for the GPU.
+    inline std::size_t get_stall_count() const { return m_stalls; }
+};
\ No newline at end of file
@@ -0,0 +1,259 @@
+#include "uniform_buffer.hpp"
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "errors.hpp"
+#include "state_cache.hpp"
+
+static std::size_t align_up(std::size_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+UniformBlockMember UniformBlockLayout::add(const std::string& name, UniformType type,
+                                           std::size_t count)
+{
+    std::size_t alignment = 0;
+    std::size_t size = 0;
+
+    switch (type) {
+    case UniformType::Float:
+    case UniformType::Int:
+        alignment = 4;
+        size = 4;
+        break;
+    case UniformType::Vec2:
+        alignment = 8;
+        size = 8;
+        break;
+    case UniformType::Vec3:
+        alignment = 16;
+        size = 12;
+        break;
+    case UniformType::Vec4:
+        alignment = 16;
+        size = 16;
+        break;
+    case UniformType::Mat3:
+        // Three columns, each one laid out like a vec4.
+        alignment = 16;
+        size = 48;
+        break;
+    case UniformType::Mat4:
+        alignment = 16;
+        size = 64;
+        break;
+    }
+
+    // Elements of arrays are always aligned like a vec4.
+    std::size_t stride = size;
+    if (count > 1) {
+        alignment = align_up(alignment, 16);
+        stride = align_up(size, 16);
+    }
+
+    UniformBlockMember member;
+    member.name = name;
+    member.type = type;
+    member.count = count;
+    member.offset = align_up(m_size, alignment);
+    member.size = size;
+    member.stride = stride;
+
+    if (count > 1)
+        m_size = member.offset + stride * count;
+    else
+        m_size = member.offset + size;
+
+    m_members.push_back(member);
+
+    return member;
+}
+
+const UniformBlockMember* UniformBlockLayout::get_member(std::string_view name) const
+{
+    for (const auto& member : m_members) {
+        if (member.name == name)
+            return &member;
+    }
+
+    return nullptr;
+}
+
+std::size_t UniformBlockLayout::get_size() const
+{
+    return align_up(m_size, 16);
+}
+
+UniformBuffer::UniformBuffer(const UniformBlockLayout& layout, GLuint binding)
+    : m_binding(binding), m_layout(layout),
+      m_data(layout.get_size(), 0),
+      m_dirty_begin(0), m_dirty_end(0)
+{
+    gl(GenBuffers, 1, &m_ubo);
+    gl_count_names(buffers, 1);
+    gl_state().bind_buffer(GL_UNIFORM_BUFFER, m_ubo);
+    gl(BufferData, GL_UNIFORM_BUFFER, m_data.size(), m_data.data(), GL_DYNAMIC_DRAW);
+    gl_count_upload(m_data.size());
+    gl_state().bind_buffer(GL_UNIFORM_BUFFER, 0);
+
+    gl_state().bind_buffer_base(GL_UNIFORM_BUFFER, m_binding, m_ubo);
+}
+
+UniformBuffer::~UniformBuffer()
+{
+    if (!m_ubo)
+        return;
+
+    gl(DeleteBuffers, 1, &m_ubo);
+    gl_count_names(buffers, -1);
+    gl_state().forget_buffer(m_ubo);
+}
+
+UniformBuffer::UniformBuffer(UniformBuffer&& other)
+    : m_ubo(std::exchange(other.m_ubo, 0)), m_binding(other.m_binding),
+      m_layout(std::move(other.m_layout)), m_data(std::move(other.m_data)),
+      m_dirty_begin(other.m_dirty_begin), m_dirty_end(other.m_dirty_end)
+{
+}
+
+UniformBuffer& UniformBuffer::operator=(UniformBuffer&& other)
+{
+    // `other` deletes what this buffer had.
+    std::swap(m_ubo, other.m_ubo);
+    std::swap(m_binding, other.m_binding);
+    std::swap(m_layout, other.m_layout);
+    std::swap(m_data, other.m_data);
+    std::swap(m_dirty_begin, other.m_dirty_begin);
+    std::swap(m_dirty_end, other.m_dirty_end);
+
+    return *this;
+}
+
+void UniformBuffer::bind() const
+{
+    gl_state().bind_buffer_base(GL_UNIFORM_BUFFER, m_binding, m_ubo);
+}
+
+void UniformBuffer::unbind() const
+{
+    gl_state().bind_buffer_base(GL_UNIFORM_BUFFER, m_binding, 0);
+}
+
+void UniformBuffer::upload()
+{
+    if (m_dirty_begin >= m_dirty_end)
+        return;
+
+    gl_state().bind_buffer(GL_UNIFORM_BUFFER, m_ubo);
+    gl(BufferSubData, GL_UNIFORM_BUFFER, m_dirty_begin, m_dirty_end - m_dirty_begin,
+                      m_data.data() + m_dirty_begin);
+    gl_count_upload(m_dirty_end - m_dirty_begin);
+    gl_state().bind_buffer(GL_UNIFORM_BUFFER, 0);
+
+    m_dirty_begin = 0;
+    m_dirty_end = 0;
+}
+
+static const char* uniform_type_name(UniformType type)
+{
+    switch (type) {
+    case UniformType::Float: return "float";
+    case UniformType::Int:   return "int";
+    case UniformType::Vec2:  return "vec2";
+    case UniformType::Vec3:  return "vec3";
+    case UniformType::Vec4:  return "vec4";
+    case UniformType::Mat3:  return "mat3";
+    case UniformType::Mat4:  return "mat4";
+    }
+
+    return "?";
+}
+
+void UniformBuffer::write(const UniformBlockMember& member, UniformType type,
+                          std::size_t index, const void* data, std::size_t size)
+{
+    if (member.type != type) {
+        std::cerr << "ERROR: uniform `" << member.name << "` is a "
+                  << uniform_type_name(member.type) << ", not a "
+                  << uniform_type_name(type) << std::endl;
+        return;
+    }
+
+    if (index >= member.count) {
+        std::cerr << "ERROR: index " << index << " out of bounds for uniform `"
+                  << member.name << "`" << std::endl;
+        return;
+    }
+
+    // E.g. a member of another layout.
+    std::size_t offset = member.offset + member.stride * index;
+    if (offset > m_data.size() || size > m_data.size() - offset) {
+        std::cerr << "ERROR: uniform `" << member.name << "` is out of bounds of the buffer"
+                  << std::endl;
+        return;
+    }
+
+    std::memcpy(m_data.data() + offset, data, size);
+
+    if (m_dirty_begin >= m_dirty_end) {
+        m_dirty_begin = offset;
+        m_dirty_end = offset + size;
+    } else {
+        m_dirty_begin = std::min(m_dirty_begin, offset);
+        m_dirty_end = std::max(m_dirty_end, offset + size);
+    }
+}
+
+void UniformBuffer::set_float(const UniformBlockMember& member, float x, std::size_t index)
+{
+    write(member, UniformType::Float, index, &x, sizeof(x));
+}
+
+void UniformBuffer::set_int(const UniformBlockMember& member, int x, std::size_t index)
+{
+    write(member, UniformType::Int, index, &x, sizeof(x));
+}
+
+void UniformBuffer::set_vec2(const UniformBlockMember& member, float x, float y,
+                             std::size_t index)
+{
+    float values[] = { x, y };
+    write(member, UniformType::Vec2, index, values, sizeof(values));
+}
+
+void UniformBuffer::set_vec3(const UniformBlockMember& member, float x, float y, float z,
+                             std::size_t index)
+{
+    float values[] = { x, y, z };
+    write(member, UniformType::Vec3, index, values, sizeof(values));
+}
+
+void UniformBuffer::set_vec4(const UniformBlockMember& member, 
+                             float x, float y, float z, float w,
+                             std::size_t index)
+{
+    float values[] = { x, y, z, w };
+    write(member, UniformType::Vec4, index, values, sizeof(values));
+}
+
+void UniformBuffer::set_mat3(const UniformBlockMember& member, const float* matrix,
+                             std::size_t index)
+{
+    // Pad every column to a vec4.
+    float columns[12] = {};
+    for (int column = 0; column < 3; ++column) {
+        std::memcpy(&columns[column * 4], &matrix[column * 3], sizeof(float) * 3);
+    }
+
+    write(member, UniformType::Mat3, index, columns, sizeof(columns));
+}
+
+void UniformBuffer::set_mat4(const UniformBlockMember& member, const float* matrix,
+                             std::size_t index)
+{
+    write(member, UniformType::Mat4, index, matrix, sizeof(float) * 16);
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+enum class UniformType {
+    Float,
+    Int,
+    Vec2,
+    Vec3,
+    Vec4,
+    Mat3,
+    Mat4,
+};
+
+struct UniformBlockMember {
+    std::string name;
+    UniformType type;
+    std::size_t count;
+    std::size_t offset;
+    // Of one element, following the std140 rules.
+    std::size_t size;
+    std::size_t stride;
+};
+
+// Description of a `layout(std140)` uniform block. Members must be
+// added in the same order they are declared in the GLSL block,
+// their offsets are computed following the std140 rules.
+class UniformBlockLayout {
+private:
+    std::vector<UniformBlockMember> m_members;
+    std::size_t m_size = 0;
+
+public:
+    UniformBlockMember add(const std::string& name, UniformType type,
+                           std::size_t count = 1);
+
+    const UniformBlockMember* get_member(std::string_view name) const;
+
+    inline const std::vector<UniformBlockMember>& get_members() const { return m_members; }
+
+    // Size of the whole block, padded to a multiple of a vec4.
+    std::size_t get_size() const;
+};
+
+// A buffer backing a uniform block, bound to a binding point
+// that can be shared by any number of shaders
+// (see `Shader::bind_uniform_block`).
+// Setters only write to a CPU-side copy, `upload` sends
+// everything that changed with a single `glBufferSubData`.
+class UniformBuffer {
+private:
+    GLuint m_ubo;
+    GLuint m_binding;
+
+    UniformBlockLayout m_layout;
+    std::vector<unsigned char> m_data;
+
+    std::size_t m_dirty_begin;
+    std::size_t m_dirty_end;
+
+    // `type` is what the setter writes, it must be the type of `member`.
+    void write(const UniformBlockMember& member, UniformType type, std::size_t index,
+               const void* data, std::size_t size);
+
+public:
+    UniformBuffer(const UniformBlockLayout& layout, GLuint binding);
+    ~UniformBuffer();
+
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+    // A moved-from buffer owns nothing.
+    UniformBuffer(UniformBuffer&& other);
+    UniformBuffer& operator=(UniformBuffer&& other);
+
+    void bind() const;
+    void unbind() const;
+
+    void upload();
+
+    void set_float(const UniformBlockMember& member, float x, std::size_t index = 0);
+    void set_int(const UniformBlockMember& member, int x, std::size_t index = 0);
+    void set_vec2(const UniformBlockMember& member, float x, float y,
+                  std::size_t index = 0);
+    void set_vec3(const UniformBlockMember& member, float x, float y, float z,
+                  std::size_t index = 0);
+    void set_vec4(const UniformBlockMember& member, float x, float y, float z, float w,
+                  std::size_t index = 0);
+    // `matrix` is column-major, like `glUniformMatrix*` with `transpose = GL_FALSE`.
+    void set_mat3(const UniformBlockMember& member, const float* matrix,
+                  std::size_t index = 0);
+    void set_mat4(const UniformBlockMember& member, const float* matrix,
+                  std::size_t index = 0);
+
+    inline GLuint get_binding() const { return m_binding; }
+    inline const UniformBlockLayout& get_layout() const { return m_layout; }
+};
\ No newline at end of file
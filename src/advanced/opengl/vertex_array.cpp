@@ -1,56 +1,131 @@
 #include "vertex_array.hpp"
 
+#include <utility>
+
 #include "errors.hpp"
+#include "state_cache.hpp"
 
 VertexArray::VertexArray()
+    : m_index_type(GL_UNSIGNED_INT)
 {
     gl(GenVertexArrays, 1, &m_vao);
+    gl_count_names(vertex_arrays, 1);
 }
 
 VertexArray::~VertexArray()
 {
-    for (auto* ib : m_index_buffers) {
-        delete ib;
-    }
+    // The buffers are deleted after, which is fine:
+    // they are only detached from the deleted name.
+    if (!m_vao)
+        return;
+
+    gl(DeleteVertexArrays, 1, &m_vao);
+    gl_count_names(vertex_arrays, -1);
+    gl_state().forget_vertex_array(m_vao);
+}
+
+VertexArray::VertexArray(VertexArray&& other)
+    : m_vao(std::exchange(other.m_vao, 0)), m_index_type(other.m_index_type),
+      m_index_buffers(std::move(other.m_index_buffers)),
+      m_vertex_buffers(std::move(other.m_vertex_buffers)),
+      m_streaming_vertex_buffers(std::move(other.m_streaming_vertex_buffers))
+{
+}
+
+VertexArray& VertexArray::operator=(VertexArray&& other)
+{
+    // `other` deletes what this vertex array had.
+    std::swap(m_vao, other.m_vao);
+    std::swap(m_index_type, other.m_index_type);
+    std::swap(m_index_buffers, other.m_index_buffers);
+    std::swap(m_vertex_buffers, other.m_vertex_buffers);
+    std::swap(m_streaming_vertex_buffers, other.m_streaming_vertex_buffers);
 
-    for (auto* vb : m_vertex_buffers) {
-        delete vb;
-    }
+    return *this;
 }
 
 void VertexArray::bind() const
 {
-    gl(BindVertexArray, m_vao);
+    gl_state().bind_vertex_array(m_vao);
 }
 
 void VertexArray::unbind() const
 {
-    gl(BindVertexArray, 0);
+    gl_state().bind_vertex_array(0);
 }
 
 void VertexArray::unbind_all() const
 {
-    gl(BindVertexArray, 0);
-    gl(BindBuffer, GL_ELEMENT_ARRAY_BUFFER, 0);
-    gl(BindBuffer, GL_ARRAY_BUFFER, 0);
+    gl_state().bind_vertex_array(0);
+    gl_state().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    gl_state().bind_buffer(GL_ARRAY_BUFFER, 0);
 }
 
-VertexBuffer* VertexArray::bind_vertex_buffer(const void* data, std::size_t size)
+void VertexArray::draw_elements(std::size_t count, GLenum mode) const
 {
-    VertexBuffer* vb = new VertexBuffer(data, size);
-    vb->bind();
+    gl(DrawElements, mode, count, m_index_type, nullptr);
+}
 
-    m_vertex_buffers.push_back(vb);
+void VertexArray::draw_instanced(std::size_t count, std::size_t instances,
+                                 GLenum mode) const
+{
+    gl(DrawArraysInstanced, mode, 0, count, instances);
+}
 
-    return vb;
+void VertexArray::draw_elements_instanced(std::size_t count, std::size_t instances,
+                                          GLenum mode) const
+{
+    gl(DrawElementsInstanced, mode, count, m_index_type, nullptr, instances);
 }
 
-IndexBuffer* VertexArray::bind_index_buffer(const unsigned int* indices, std::size_t count)
+VertexBuffer* VertexArray::bind_vertex_buffer(const void* data, std::size_t size,
+                                              GLenum usage)
 {
-    IndexBuffer* ib = new IndexBuffer(indices, count);
-    ib->bind();
+    VertexBuffer& vb = m_vertex_buffers.emplace_front(data, size, usage);
+    vb.bind();
 
-    m_index_buffers.push_back(ib);
+    return &vb;
+}
+
+StreamingVertexBuffer* VertexArray::bind_streaming_vertex_buffer(std::size_t region_size,
+                                                                 std::size_t region_count)
+{
+    StreamingVertexBuffer& svb = m_streaming_vertex_buffers.emplace_front(region_size,
+                                                                          region_count);
+    svb.bind();
 
-    return ib;
+    return &svb;
+}
+
+IndexBuffer* VertexArray::bind_index_buffer(const unsigned int* indices, std::size_t count,
+                                            GLenum type)
+{
+    IndexBuffer& ib = m_index_buffers.emplace_front(indices, count, type);
+    ib.bind();
+
+    m_index_type = ib.get_type();
+
+    return &ib;
+}
+
+IndexBuffer* VertexArray::bind_index_buffer(const void* indices, std::size_t count, GLenum type)
+{
+    IndexBuffer& ib = m_index_buffers.emplace_front(indices, count, type);
+    ib.bind();
+
+    m_index_type = ib.get_type();
+
+    return &ib;
+}
+
+void VertexArray::set_vertex_buffer(unsigned int binding, const VertexBuffer* buffer,
+                                    std::size_t offset, std::size_t stride)
+{
+    gl(BindVertexBuffer, binding, buffer->get_id(), offset, stride);
+}
+
+void VertexArray::set_vertex_buffer(unsigned int binding, const StreamingVertexBuffer* buffer,
+                                    std::size_t offset, std::size_t stride)
+{
+    gl(BindVertexBuffer, binding, buffer->get_id(), offset, stride);
 }
\ No newline at end of file
@@ -2,27 +2,80 @@
 
 #include <GL/glew.h>
 
-#include <vector>
+#include <forward_list>
 #include <cstddef>
 
+#include "pool_allocator.hpp"
 #include "index_buffer.hpp"
 #include "vertex_buffer.hpp"
+#include "streaming_vertex_buffer.hpp"
 
 class VertexArray {
 private:
     GLuint m_vao;
 
-    std::vector<IndexBuffer*> m_index_buffers;
-    std::vector<VertexBuffer*> m_vertex_buffers;
+    // Type of the last index buffer bound with `bind_index_buffer`.
+    GLenum m_index_type;
+
+    // Owned by value. List nodes never move, so the pointers returned by
+    // the `bind_*` functions stay valid. The nodes come from a pool (an
+    // empty deque would allocate): creating and destroying vertex arrays
+    // doesn't touch the heap.
+    template <typename T>
+    using BufferList = std::forward_list<T, PoolAllocator<T>>;
+
+    BufferList<IndexBuffer> m_index_buffers;
+    BufferList<VertexBuffer> m_vertex_buffers;
+    BufferList<StreamingVertexBuffer> m_streaming_vertex_buffers;
 
 public:
     VertexArray();
     ~VertexArray();
 
+    VertexArray(const VertexArray&) = delete;
+    VertexArray& operator=(const VertexArray&) = delete;
+    // A moved-from vertex array owns nothing. Pointers to the
+    // buffers stay valid, they now belong to the new one.
+    VertexArray(VertexArray&& other);
+    VertexArray& operator=(VertexArray&& other);
+
     void bind() const;
     void unbind() const;
     void unbind_all() const;
 
-    VertexBuffer* bind_vertex_buffer(const void* data, std::size_t size);
-    IndexBuffer* bind_index_buffer(const unsigned int* indices, std::size_t count);
+    // The vertex array must be bound.
+    void draw_elements(std::size_t count, GLenum mode = GL_TRIANGLES) const;
+    void draw_instanced(std::size_t count, std::size_t instances,
+                        GLenum mode = GL_TRIANGLES) const;
+    void draw_elements_instanced(std::size_t count, std::size_t instances,
+                                 GLenum mode = GL_TRIANGLES) const;
+
+    VertexBuffer* bind_vertex_buffer(const void* data, std::size_t size,
+                                     GLenum usage = GL_STATIC_DRAW);
+    StreamingVertexBuffer* bind_streaming_vertex_buffer(std::size_t region_size, 
+                                                        std::size_t region_count = 3);
+    IndexBuffer* bind_index_buffer(const unsigned int* indices, std::size_t count,
+                                   GLenum type = GL_NONE);
+    IndexBuffer* bind_index_buffer(const void* indices, std::size_t count, GLenum type);
+
+    inline GLuint get_id() const { return m_vao; }
+    inline GLenum get_index_type() const { return m_index_type; }
+
+    // Separate attribute formats (GL 4.3, see `vertex_attribute_formats_supported`):
+    // the formats are set once and buffers are attached to `binding` later,
+    // so switching buffers is a single `glBindVertexBuffer`.
+    // The vertex array must be bound.
+    template <typename Layout>
+    inline void set_layout(unsigned int binding, unsigned int first_index = 0,
+                           unsigned int divisor = 0)
+    {
+        Layout::apply_format(binding, first_index, divisor);
+    }
+
+    // `stride` is usually the `stride` of the layout set on `binding`.
+    // The vertex array must be bound.
+    void set_vertex_buffer(unsigned int binding, const VertexBuffer* buffer,
+                           std::size_t offset, std::size_t stride);
+    void set_vertex_buffer(unsigned int binding, const StreamingVertexBuffer* buffer,
+                           std::size_t offset, std::size_t stride);
 };
\ No newline at end of file
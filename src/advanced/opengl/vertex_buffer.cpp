@@ -1,35 +1,71 @@
 #include "vertex_buffer.hpp"
 
+#include <utility>
+
 #include "errors.hpp"
+#include "state_cache.hpp"
 
-VertexBuffer::VertexBuffer(const void* data, std::size_t size)
+VertexBuffer::VertexBuffer(const void* data, std::size_t size, GLenum usage)
+    : m_usage(usage)
 {
     gl(GenBuffers, 1, &m_vbo);
-    gl(BindBuffer, GL_ARRAY_BUFFER, m_vbo);
-    gl(BufferData, GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
-    gl(BindBuffer, GL_ARRAY_BUFFER, 0);
+    gl_count_names(buffers, 1);
+    gl_state().bind_buffer(GL_ARRAY_BUFFER, m_vbo);
+    gl(BufferData, GL_ARRAY_BUFFER, size, data, m_usage);
+    gl_state().bind_buffer(GL_ARRAY_BUFFER, 0);
+
+    if (data)
+        gl_count_upload(size);
 }
 
 VertexBuffer::~VertexBuffer()
 {
+    if (!m_vbo)
+        return;
+
     gl(DeleteBuffers, 1, &m_vbo);
+    gl_count_names(buffers, -1);
+    gl_state().forget_buffer(m_vbo);
+}
+
+VertexBuffer::VertexBuffer(VertexBuffer&& other)
+    : m_vbo(std::exchange(other.m_vbo, 0)), m_usage(other.m_usage)
+{
+}
+
+VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other)
+{
+    // `other` deletes what this buffer had.
+    std::swap(m_vbo, other.m_vbo);
+    std::swap(m_usage, other.m_usage);
+
+    return *this;
 }
 
 void VertexBuffer::set_attribute_layout(int index, int component_count, GLenum component_type,
                                         bool normalized, std::size_t stride, 
-                                        std::size_t offset)
+                                        std::size_t offset, unsigned int divisor)
 {
     gl(VertexAttribPointer, index, component_count, component_type, 
                             normalized, stride, (void*)offset);
     gl(EnableVertexAttribArray, index);
+
+    gl(VertexAttribDivisor, index, divisor);
+}
+
+void VertexBuffer::set_data(const void* data, std::size_t size)
+{
+    gl(BufferData, GL_ARRAY_BUFFER, size, nullptr, m_usage);
+    gl(BufferSubData, GL_ARRAY_BUFFER, 0, size, data);
+    gl_count_upload(size);
 }
 
 void VertexBuffer::bind() const
 {
-    gl(BindBuffer, GL_ARRAY_BUFFER, m_vbo);
+    gl_state().bind_buffer(GL_ARRAY_BUFFER, m_vbo);
 }
 
 void VertexBuffer::unbind() const
 {
-    gl(BindBuffer, GL_ARRAY_BUFFER, 0);
+    gl_state().bind_buffer(GL_ARRAY_BUFFER, 0);
 }
\ No newline at end of file
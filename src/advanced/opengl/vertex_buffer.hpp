@@ -4,18 +4,44 @@
 
 #include <cstddef>
 
+#include "vertex_layout.hpp"
+
 class VertexBuffer {
 private:
     GLuint m_vbo;
+    GLenum m_usage;
 
 public:
-    VertexBuffer(const void* data, std::size_t size);
+    VertexBuffer(const void* data, std::size_t size, GLenum usage = GL_STATIC_DRAW);
     ~VertexBuffer();
 
+    VertexBuffer(const VertexBuffer&) = delete;
+    VertexBuffer& operator=(const VertexBuffer&) = delete;
+    // A moved-from buffer owns nothing.
+    VertexBuffer(VertexBuffer&& other);
+    VertexBuffer& operator=(VertexBuffer&& other);
+
     void bind() const;
     void unbind() const;
 
+    inline GLuint get_id() const { return m_vbo; }
+
+    // Replaces the whole contents of the buffer. The old storage is
+    // orphaned, so this doesn't wait for draws still reading from it.
+    // The buffer must be bound.
+    void set_data(const void* data, std::size_t size);
+
+    // A non-zero `divisor` makes the attribute advance once every
+    // `divisor` instances instead of once per vertex.
     void set_attribute_layout(int index, int component_count, GLenum component_type,
                               bool normalized, std::size_t stride, 
-                              std::size_t offset);
+                              std::size_t offset, unsigned int divisor = 0);
+
+    // Sets every attribute of `Layout`, starting at `first_index`.
+    // The vertex array and the buffer must be bound.
+    template <typename Layout>
+    inline void set_layout(unsigned int first_index = 0, unsigned int divisor = 0)
+    {
+        Layout::apply(first_index, divisor);
+    }
 };
\ No newline at end of file
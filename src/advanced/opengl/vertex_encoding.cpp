@@ -0,0 +1,436 @@
+#include "vertex_encoding.hpp"
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+#if defined(__F16C__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+const char* vertex_encoding_name(VertexEncoding encoding)
+{
+    switch (encoding) {
+    case VertexEncoding::Float:        return "float";
+    case VertexEncoding::Half:         return "half";
+    case VertexEncoding::Unorm8:       return "unorm8";
+    case VertexEncoding::Snorm16:      return "snorm16";
+    case VertexEncoding::Snorm2101010: return "snorm 10/10/10/2";
+    case VertexEncoding::Unorm2101010: return "unorm 10/10/10/2";
+    }
+
+    return "unknown";
+}
+
+bool vertex_encoding_simd()
+{
+#if defined(__F16C__) && defined(__SSE2__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Rounds to nearest even, like the hardware does.
+static std::uint16_t float_to_half(float value)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    std::uint32_t sign = (bits >> 16) & 0x8000;
+    std::uint32_t exponent = (bits >> 23) & 0xff;
+    std::uint32_t mantissa = bits & 0x7fffff;
+
+    // Infinity and NaN (keeping NaNs quiet).
+    if (exponent == 0xff)
+        return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+
+    int half_exponent = (int)exponent - 127 + 15;
+
+    if (half_exponent >= 31)
+        return sign | 0x7c00;
+
+    if (half_exponent <= 0) {
+        // Subnormal, or too small for even that.
+        if (half_exponent < -10)
+            return sign;
+
+        mantissa |= 0x800000;
+        std::uint32_t shift = 14 - half_exponent;
+        std::uint32_t half = mantissa >> shift;
+        std::uint32_t rest = mantissa & ((1u << shift) - 1);
+        std::uint32_t halfway = 1u << (shift - 1);
+
+        if (rest > halfway || (rest == halfway && (half & 1)))
+            half++;
+
+        return sign | half;
+    }
+
+    std::uint32_t half = ((std::uint32_t)half_exponent << 10) | (mantissa >> 13);
+    std::uint32_t rest = mantissa & 0x1fff;
+
+    // A carry out of the mantissa correctly bumps the exponent.
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+        half++;
+
+    return sign | half;
+}
+
+static float half_to_float(std::uint16_t half)
+{
+    std::uint32_t sign = (std::uint32_t)(half & 0x8000) << 16;
+    std::uint32_t exponent = (half >> 10) & 0x1f;
+    std::uint32_t mantissa = half & 0x3ff;
+
+    if (exponent == 0) {
+        float value = std::ldexp((float)mantissa, -24);
+        return sign ? -value : value;
+    }
+
+    std::uint32_t bits;
+    if (exponent == 31)
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    else
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// NaNs end up as `min`, like with `_mm_max_ps`.
+static float clamp(float value, float min, float max)
+{
+    return value > min ? (value < max ? value : max) : min;
+}
+
+void encode_half(const float* source, Half* destination, std::size_t count)
+{
+    std::size_t i = 0;
+
+#if defined(__F16C__)
+    for (; i + 8 <= count; i += 8) {
+        __m256 values = _mm256_loadu_ps(source + i);
+        __m128i halves = _mm256_cvtps_ph(values, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i*)(destination + i), halves);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        destination[i].bits = float_to_half(source[i]);
+    }
+}
+
+void decode_half(const Half* source, float* destination, std::size_t count)
+{
+    std::size_t i = 0;
+
+#if defined(__F16C__)
+    for (; i + 8 <= count; i += 8) {
+        __m128i halves = _mm_loadu_si128((const __m128i*)(source + i));
+        _mm256_storeu_ps(destination + i, _mm256_cvtph_ps(halves));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        destination[i] = half_to_float(source[i].bits);
+    }
+}
+
+void encode_unorm8(const float* source, std::uint8_t* destination, std::size_t count)
+{
+    std::size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 max = _mm_set1_ps(255.0f);
+
+    auto convert = [&](const float* values) {
+        __m128 clamped = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(values), zero), one);
+        return _mm_cvtps_epi32(_mm_mul_ps(clamped, max));
+    };
+
+    for (; i + 16 <= count; i += 16) {
+        __m128i low = _mm_packs_epi32(convert(source + i), convert(source + i + 4));
+        __m128i high = _mm_packs_epi32(convert(source + i + 8), convert(source + i + 12));
+        _mm_storeu_si128((__m128i*)(destination + i), _mm_packus_epi16(low, high));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        destination[i] = (std::uint8_t)std::lrint(clamp(source[i], 0.0f, 1.0f) * 255.0f);
+    }
+}
+
+void encode_snorm16(const float* source, std::int16_t* destination, std::size_t count)
+{
+    std::size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128 min = _mm_set1_ps(-1.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 max = _mm_set1_ps(32767.0f);
+
+    auto convert = [&](const float* values) {
+        __m128 clamped = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(values), min), one);
+        return _mm_cvtps_epi32(_mm_mul_ps(clamped, max));
+    };
+
+    for (; i + 8 <= count; i += 8) {
+        __m128i values = _mm_packs_epi32(convert(source + i), convert(source + i + 4));
+        _mm_storeu_si128((__m128i*)(destination + i), values);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        destination[i] = (std::int16_t)std::lrint(clamp(source[i], -1.0f, 1.0f) * 32767.0f);
+    }
+}
+
+// Packed formats are scalar, every vertex is a single word anyway.
+static std::uint32_t encode_2101010(const float* value, bool is_signed)
+{
+    std::uint32_t word = 0;
+
+    for (int i = 0; i < 4; ++i) {
+        int bits = i == 3 ? 2 : 10;
+        std::int32_t component;
+
+        if (is_signed) {
+            float max = (float)((1 << (bits - 1)) - 1);
+            component = std::lrint(clamp(value[i], -1.0f, 1.0f) * max);
+        } else {
+            float max = (float)((1 << bits) - 1);
+            component = std::lrint(clamp(value[i], 0.0f, 1.0f) * max);
+        }
+
+        word |= ((std::uint32_t)component & ((1u << bits) - 1)) << (i * 10);
+    }
+
+    return word;
+}
+
+static void decode_2101010(std::uint32_t word, bool is_signed, float* value)
+{
+    for (int i = 0; i < 4; ++i) {
+        int bits = i == 3 ? 2 : 10;
+        std::uint32_t component = (word >> (i * 10)) & ((1u << bits) - 1);
+
+        if (is_signed) {
+            // Sign extend, then GL's snorm rule: max(c / (2^(b-1) - 1), -1).
+            std::int32_t extended = (std::int32_t)(component << (32 - bits)) >> (32 - bits);
+            value[i] = std::max((float)extended / (float)((1 << (bits - 1)) - 1), -1.0f);
+        } else {
+            value[i] = (float)component / (float)((1 << bits) - 1);
+        }
+    }
+}
+
+static std::size_t encoded_size(VertexEncoding encoding, int components)
+{
+    switch (encoding) {
+    case VertexEncoding::Float:        return components * 4;
+    case VertexEncoding::Half:         return components * 2;
+    case VertexEncoding::Unorm8:       return components;
+    case VertexEncoding::Snorm16:      return components * 2;
+    case VertexEncoding::Snorm2101010: return 4;
+    case VertexEncoding::Unorm2101010: return 4;
+    }
+
+    return 0;
+}
+
+static VertexAttribute encoded_attribute(VertexEncoding encoding, int components, 
+                                         std::size_t offset)
+{
+    switch (encoding) {
+    case VertexEncoding::Float:
+        return { components, GL_FLOAT, false, offset };
+    case VertexEncoding::Half:
+        return { components, GL_HALF_FLOAT, false, offset };
+    case VertexEncoding::Unorm8:
+        return { components, GL_UNSIGNED_BYTE, true, offset };
+    case VertexEncoding::Snorm16:
+        return { components, GL_SHORT, true, offset };
+    case VertexEncoding::Snorm2101010:
+        return { 4, GL_INT_2_10_10_10_REV, true, offset };
+    case VertexEncoding::Unorm2101010:
+        return { 4, GL_UNSIGNED_INT_2_10_10_10_REV, true, offset };
+    }
+
+    return {};
+}
+
+// Encodes `values` (`components` per vertex, contiguous) into `encoded`
+// (`size` bytes per vertex, contiguous) and fills in the error and the
+// dequantization of `attribute`.
+static void encode_stream(std::vector<float>& values, int components, 
+                          std::size_t vertex_count, std::vector<unsigned char>& encoded,
+                          EncodedAttribute& attribute)
+{
+    std::size_t count = values.size();
+    std::vector<float> decoded(count);
+
+    switch (attribute.encoding) {
+    case VertexEncoding::Float:
+        std::memcpy(encoded.data(), values.data(), count * sizeof(float));
+        decoded = values;
+        break;
+
+    case VertexEncoding::Half: {
+        Half* halves = (Half*)encoded.data();
+        encode_half(values.data(), halves, count);
+        decode_half(halves, decoded.data(), count);
+        break;
+    }
+
+    case VertexEncoding::Unorm8: {
+        std::uint8_t* bytes = encoded.data();
+        encode_unorm8(values.data(), bytes, count);
+        for (std::size_t i = 0; i < count; ++i) {
+            decoded[i] = bytes[i] / 255.0f;
+        }
+        break;
+    }
+
+    case VertexEncoding::Snorm16: {
+        // Map the bounds of every component to [-1, 1].
+        for (int c = 0; c < components; ++c) {
+            float min = INFINITY;
+            float max = -INFINITY;
+            for (std::size_t v = 0; v < vertex_count; ++v) {
+                min = std::min(min, values[v * components + c]);
+                max = std::max(max, values[v * components + c]);
+            }
+
+            if (vertex_count == 0) {
+                min = max = 0;
+            }
+
+            attribute.scale[c] = max > min ? (max - min) / 2.0f : 1.0f;
+            attribute.offset[c] = (max + min) / 2.0f;
+        }
+
+        std::vector<float> normalized(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            int c = i % components;
+            normalized[i] = (values[i] - attribute.offset[c]) / attribute.scale[c];
+        }
+
+        std::int16_t* shorts = (std::int16_t*)encoded.data();
+        encode_snorm16(normalized.data(), shorts, count);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            int c = i % components;
+            float value = std::max(shorts[i] / 32767.0f, -1.0f);
+            decoded[i] = value * attribute.scale[c] + attribute.offset[c];
+        }
+        break;
+    }
+
+    case VertexEncoding::Snorm2101010:
+    case VertexEncoding::Unorm2101010: {
+        bool is_signed = attribute.encoding == VertexEncoding::Snorm2101010;
+        std::uint32_t* words = (std::uint32_t*)encoded.data();
+
+        for (std::size_t v = 0; v < vertex_count; ++v) {
+            // Missing components are what GL would fill in.
+            float value[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+            std::copy_n(&values[v * components], components, value);
+
+            words[v] = encode_2101010(value, is_signed);
+
+            decode_2101010(words[v], is_signed, value);
+            std::copy_n(value, components, &decoded[v * components]);
+        }
+        break;
+    }
+    }
+
+    attribute.max_error = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        attribute.max_error = std::max(attribute.max_error, std::abs(decoded[i] - values[i]));
+    }
+}
+
+EncodedVertices encode_vertices(const std::vector<VertexStream>& streams, 
+                                std::size_t vertex_count)
+{
+    EncodedVertices vertices = {};
+    vertices.vertex_count = vertex_count;
+
+    std::vector<std::size_t> sizes;
+
+    for (const VertexStream& stream : streams) {
+        std::size_t size = encoded_size(stream.encoding, stream.components);
+        sizes.push_back(size);
+
+        EncodedAttribute attribute = {};
+        attribute.encoding = stream.encoding;
+        attribute.attribute = encoded_attribute(stream.encoding, stream.components, 
+                                                vertices.stride);
+        std::fill_n(attribute.scale, 4, 1.0f);
+        vertices.attributes.push_back(attribute);
+
+        // Attributes that aren't 4-byte aligned are slow (or emulated)
+        // on a lot of hardware.
+        vertices.stride += (size + 3) / 4 * 4;
+        vertices.source_size += stream.components * sizeof(float) * vertex_count;
+    }
+
+    vertices.data.resize(vertices.stride * vertex_count);
+
+    std::vector<float> values;
+    std::vector<unsigned char> encoded;
+
+    for (std::size_t s = 0; s < streams.size(); ++s) {
+        const VertexStream& stream = streams[s];
+        EncodedAttribute& attribute = vertices.attributes[s];
+        std::size_t stride = stream.stride ? stream.stride : stream.components;
+
+        // Kernels work best on contiguous data, so every stream is
+        // gathered, converted in one go and scattered into place.
+        values.resize(vertex_count * stream.components);
+        for (std::size_t v = 0; v < vertex_count; ++v) {
+            std::copy_n(stream.data + v * stride, stream.components, 
+                        &values[v * stream.components]);
+        }
+
+        encoded.resize(vertex_count * sizes[s]);
+        encode_stream(values, stream.components, vertex_count, encoded, attribute);
+
+        for (std::size_t v = 0; v < vertex_count; ++v) {
+            std::memcpy(&vertices.data[v * vertices.stride + attribute.attribute.offset],
+                        &encoded[v * sizes[s]], sizes[s]);
+        }
+    }
+
+    return vertices;
+}
+
+void EncodedVertices::apply(unsigned int first_index, unsigned int divisor) const
+{
+    std::vector<VertexAttribute> layout;
+    for (const EncodedAttribute& attribute : attributes) {
+        layout.push_back(attribute.attribute);
+    }
+
+    apply_vertex_attributes(layout.data(), layout.size(), stride, first_index, divisor);
+}
+
+void EncodedVertices::report() const
+{
+    std::cout << "INFO: encoded " << vertex_count << " vertices: "
+              << source_size << " -> " << data.size() << " bytes ("
+              << (data.empty() ? 0.0 : (double)source_size / data.size()) << "x smaller)" 
+              << std::endl;
+
+    for (std::size_t i = 0; i < attributes.size(); ++i) {
+        std::cout << " > attribute " << i << ": " 
+                  << vertex_encoding_name(attributes[i].encoding)
+                  << ", max error " << attributes[i].max_error << std::endl;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "vertex_layout.hpp"
+
+// Smaller encodings for float vertex attributes, from the most to the
+// least precise. The shader still reads floats (the integer encodings
+// are normalized), so only the layout changes.
+enum class VertexEncoding {
+    // 4 bytes per component, as is.
+    Float,
+    // 2 bytes per component, ~3 significant digits.
+    Half,
+    // 1 byte per component, [0, 1] in steps of 1/255. For colors.
+    Unorm8,
+    // 2 bytes per component, quantized to the bounds of the stream
+    // (see `EncodedAttribute::scale`). For positions.
+    Snorm16,
+    // 4 components in 4 bytes, [-1, 1] in steps of 1/511 (and w in
+    // {-1, 0, 1}). For normals and tangents.
+    Snorm2101010,
+    // 4 components in 4 bytes, [0, 1] in steps of 1/1023 (and w in
+    // steps of 1/3). For colors that don't need much alpha.
+    Unorm2101010,
+};
+
+const char* vertex_encoding_name(VertexEncoding encoding);
+
+// One attribute of the source vertices: `components` floats per vertex,
+// `stride` floats apart (0 means tightly packed).
+struct VertexStream {
+    const float* data;
+    int components;
+    VertexEncoding encoding;
+    std::size_t stride = 0;
+};
+
+struct EncodedAttribute {
+    VertexEncoding encoding;
+    VertexAttribute attribute;
+
+    // The shader gets `value * scale + offset` back from what it reads,
+    // 1 and 0 for anything but `Snorm16`.
+    float scale[4];
+    float offset[4];
+
+    // Largest difference between a source and a decoded component.
+    float max_error;
+};
+
+struct EncodedVertices {
+    std::vector<unsigned char> data;
+    std::vector<EncodedAttribute> attributes;
+    std::size_t stride;
+    std::size_t vertex_count;
+
+    // Size of the same vertices as floats.
+    std::size_t source_size;
+
+    // Sets the attributes like `VertexLayout::apply` would.
+    // The vertex array and the buffer must be bound.
+    void apply(unsigned int first_index = 0, unsigned int divisor = 0) const;
+
+    // Prints the size before and after, and the error of every attribute.
+    void report() const;
+};
+
+// Interleaves the streams into one buffer, each attribute aligned to 4 bytes.
+EncodedVertices encode_vertices(const std::vector<VertexStream>& streams, 
+                                std::size_t vertex_count);
+
+// Conversion kernels, for `count` contiguous components. They use
+// F16C / SSE2 when the build targets them (`-march`, see build.sh).
+void encode_half(const float* source, Half* destination, std::size_t count);
+void decode_half(const Half* source, float* destination, std::size_t count);
+void encode_unorm8(const float* source, std::uint8_t* destination, std::size_t count);
+void encode_snorm16(const float* source, std::int16_t* destination, std::size_t count);
+
+// Whether the kernels above were built with SIMD.
+bool vertex_encoding_simd();
\ No newline at end of file
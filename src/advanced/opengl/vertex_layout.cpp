@@ -0,0 +1,43 @@
+#include "vertex_layout.hpp"
+
+#include "errors.hpp"
+
+void apply_vertex_attributes(const VertexAttribute* attributes, std::size_t count,
+                             std::size_t stride, unsigned int first_index,
+                             unsigned int divisor)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        const VertexAttribute& attribute = attributes[i];
+        GLuint index = first_index + i;
+
+        gl(VertexAttribPointer, index, attribute.count, attribute.type,
+                                attribute.normalized, stride, (void*)attribute.offset);
+        gl(EnableVertexAttribArray, index);
+
+        // Also when 0: the index may have been instanced before.
+        gl(VertexAttribDivisor, index, divisor);
+    }
+}
+
+void apply_vertex_attribute_formats(const VertexAttribute* attributes, std::size_t count,
+                                    unsigned int binding, unsigned int first_index,
+                                    unsigned int divisor)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        const VertexAttribute& attribute = attributes[i];
+        GLuint index = first_index + i;
+
+        gl(VertexAttribFormat, index, attribute.count, attribute.type,
+                               attribute.normalized, attribute.offset);
+        gl(VertexAttribBinding, index, binding);
+        gl(EnableVertexAttribArray, index);
+    }
+
+    // The divisor belongs to the binding with separate formats.
+    gl(VertexBindingDivisor, binding, divisor);
+}
+
+bool vertex_attribute_formats_supported()
+{
+    return GLEW_ARB_vertex_attrib_binding || GLEW_VERSION_4_3;
+}
\ No newline at end of file
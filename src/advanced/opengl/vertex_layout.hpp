@@ -0,0 +1,193 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Component types that aren't plain C++ types.
+
+// An IEEE half float, see `GL_HALF_FLOAT`.
+struct Half {
+    std::uint16_t bits;
+};
+
+// Four components in one 32-bit word, `GL_INT_2_10_10_10_REV` and
+// `GL_UNSIGNED_INT_2_10_10_10_REV`: x in the lowest 10 bits, then y,
+// z and w in the highest 2.
+struct Int2101010Rev {
+    std::uint32_t bits;
+};
+
+struct UInt2101010Rev {
+    std::uint32_t bits;
+};
+
+template <typename T> struct VertexComponent;
+
+template <> struct VertexComponent<float>          { static constexpr GLenum type = GL_FLOAT; };
+template <> struct VertexComponent<Half>           { static constexpr GLenum type = GL_HALF_FLOAT; };
+template <> struct VertexComponent<std::int8_t>    { static constexpr GLenum type = GL_BYTE; };
+template <> struct VertexComponent<std::uint8_t>   { static constexpr GLenum type = GL_UNSIGNED_BYTE; };
+template <> struct VertexComponent<std::int16_t>   { static constexpr GLenum type = GL_SHORT; };
+template <> struct VertexComponent<std::uint16_t>  { static constexpr GLenum type = GL_UNSIGNED_SHORT; };
+template <> struct VertexComponent<std::int32_t>   { static constexpr GLenum type = GL_INT; };
+template <> struct VertexComponent<std::uint32_t>  { static constexpr GLenum type = GL_UNSIGNED_INT; };
+template <> struct VertexComponent<Int2101010Rev>  { static constexpr GLenum type = GL_INT_2_10_10_10_REV; };
+template <> struct VertexComponent<UInt2101010Rev> { static constexpr GLenum type = GL_UNSIGNED_INT_2_10_10_10_REV; };
+
+template <typename T>
+constexpr bool is_packed_vertex_component = false;
+template <>
+inline constexpr bool is_packed_vertex_component<Int2101010Rev> = true;
+template <>
+inline constexpr bool is_packed_vertex_component<UInt2101010Rev> = true;
+
+// An attribute of `Count` components of type `T`, like a `T member[Count]`
+// in the vertex struct (or a single `T` for the packed types, which
+// always have 4 components). Integer components are converted to floats,
+// to [0, 1] (or [-1, 1] if signed) if `Normalized`.
+template <typename T, int Count, bool Normalized = false>
+struct Attr {
+    static_assert(Count >= 1 && Count <= 4, "attributes have 1 to 4 components");
+    static_assert(!is_packed_vertex_component<T> || Count == 4,
+                  "packed attributes have 4 components");
+
+    static constexpr GLenum type = VertexComponent<T>::type;
+    static constexpr int count = Count;
+    static constexpr bool normalized = Normalized;
+
+    static constexpr std::size_t size = is_packed_vertex_component<T> ? sizeof(T)
+                                                                      : sizeof(T) * Count;
+    static constexpr std::size_t alignment = alignof(T);
+};
+
+struct VertexAttribute {
+    GLint count;
+    GLenum type;
+    bool normalized;
+    std::size_t offset;
+};
+
+// Sets attributes `first_index`, `first_index + 1`, ... of the bound
+// vertex array to read from the bound `GL_ARRAY_BUFFER`.
+void apply_vertex_attributes(const VertexAttribute* attributes, std::size_t count,
+                             std::size_t stride, unsigned int first_index,
+                             unsigned int divisor);
+
+// Same, with separate attribute formats (GL 4.3): the attributes read
+// from whatever buffer is attached to `binding` (see `VertexArray::set_vertex_buffer`).
+void apply_vertex_attribute_formats(const VertexAttribute* attributes, std::size_t count,
+                                    unsigned int binding, unsigned int first_index,
+                                    unsigned int divisor);
+
+bool vertex_attribute_formats_supported();
+
+namespace vertex_layout_detail {
+
+template <typename Layout, typename Vertex, std::size_t N>
+constexpr bool offsets_match(const std::size_t (&offsets)[N])
+{
+    static_assert(N == Layout::count, "every attribute needs a member");
+
+    for (std::size_t i = 0; i < N; ++i) {
+        if (Layout::offset(i) != offsets[i])
+            return false;
+    }
+
+    return true;
+}
+
+}
+
+// Checks that `Layout` has the size of `Vertex` and that its attributes
+// are at the offsets of the given members, in order.
+#define VERTEX_LAYOUT_OFFSETS_1(V, a) offsetof(V, a)
+#define VERTEX_LAYOUT_OFFSETS_2(V, a, ...) offsetof(V, a), VERTEX_LAYOUT_OFFSETS_1(V, __VA_ARGS__)
+#define VERTEX_LAYOUT_OFFSETS_3(V, a, ...) offsetof(V, a), VERTEX_LAYOUT_OFFSETS_2(V, __VA_ARGS__)
+#define VERTEX_LAYOUT_OFFSETS_4(V, a, ...) offsetof(V, a), VERTEX_LAYOUT_OFFSETS_3(V, __VA_ARGS__)
+#define VERTEX_LAYOUT_OFFSETS_5(V, a, ...) offsetof(V, a), VERTEX_LAYOUT_OFFSETS_4(V, __VA_ARGS__)
+#define VERTEX_LAYOUT_OFFSETS_6(V, a, ...) offsetof(V, a), VERTEX_LAYOUT_OFFSETS_5(V, __VA_ARGS__)
+#define VERTEX_LAYOUT_OFFSETS_7(V, a, ...) offsetof(V, a), VERTEX_LAYOUT_OFFSETS_6(V, __VA_ARGS__)
+#define VERTEX_LAYOUT_OFFSETS_8(V, a, ...) offsetof(V, a), VERTEX_LAYOUT_OFFSETS_7(V, __VA_ARGS__)
+#define VERTEX_LAYOUT_PICK(_1, _2, _3, _4, _5, _6, _7, _8, name, ...) name
+#define VERTEX_LAYOUT_OFFSETS(V, ...)                                        \
+    VERTEX_LAYOUT_PICK(__VA_ARGS__, VERTEX_LAYOUT_OFFSETS_8,                 \
+                       VERTEX_LAYOUT_OFFSETS_7, VERTEX_LAYOUT_OFFSETS_6,     \
+                       VERTEX_LAYOUT_OFFSETS_5, VERTEX_LAYOUT_OFFSETS_4,     \
+                       VERTEX_LAYOUT_OFFSETS_3, VERTEX_LAYOUT_OFFSETS_2,     \
+                       VERTEX_LAYOUT_OFFSETS_1)(V, __VA_ARGS__)
+
+#define VERTEX_LAYOUT_CHECK(Layout, Vertex, ...)                                      \
+    static_assert(Layout::stride == sizeof(Vertex),                                  \
+                  #Layout " doesn't have the size of " #Vertex);                      \
+    static_assert(vertex_layout_detail::offsets_match<Layout, Vertex>(               \
+                      { VERTEX_LAYOUT_OFFSETS(Vertex, __VA_ARGS__) }),                \
+                  #Layout " doesn't match the members of " #Vertex)
+
+// The layout of an interleaved vertex, with offsets laid out like the
+// members of a struct (each aligned to its component type). Check it
+// against the struct with `VERTEX_LAYOUT_CHECK`:
+//
+//     struct Vertex {
+//         float x, y;
+//         std::uint8_t color[4];
+//     };
+//
+//     using VertexFormat = VertexLayout<Attr<float, 2>, Attr<std::uint8_t, 4, true>>;
+//     VERTEX_LAYOUT_CHECK(VertexFormat, Vertex, x, color);
+template <typename... Attrs>
+struct VertexLayout {
+    static constexpr std::size_t count = sizeof...(Attrs);
+
+private:
+    static constexpr std::size_t align_up(std::size_t value, std::size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    static constexpr std::array<VertexAttribute, count> make_attributes()
+    {
+        std::array<VertexAttribute, count> attributes = {};
+
+        std::size_t offset = 0;
+        std::size_t i = 0;
+        ((offset = align_up(offset, Attrs::alignment),
+          attributes[i++] = { Attrs::count, Attrs::type, Attrs::normalized, offset },
+          offset += Attrs::size), ...);
+
+        return attributes;
+    }
+
+    static constexpr std::size_t make_stride()
+    {
+        std::size_t end = 0;
+        ((end = align_up(end, Attrs::alignment) + Attrs::size), ...);
+
+        std::size_t alignment = 1;
+        ((alignment = Attrs::alignment > alignment ? Attrs::alignment : alignment), ...);
+
+        return align_up(end, alignment);
+    }
+
+public:
+    static constexpr std::array<VertexAttribute, count> attributes = make_attributes();
+    static constexpr std::size_t stride = make_stride();
+
+    static constexpr std::size_t offset(std::size_t index) { return attributes[index].offset; }
+
+    // The vertex array and the buffer must be bound.
+    static void apply(unsigned int first_index = 0, unsigned int divisor = 0)
+    {
+        apply_vertex_attributes(attributes.data(), count, stride, first_index, divisor);
+    }
+
+    // The vertex array must be bound.
+    static void apply_format(unsigned int binding, unsigned int first_index = 0,
+                             unsigned int divisor = 0)
+    {
+        apply_vertex_attribute_formats(attributes.data(), count, binding,
+                                       first_index, divisor);
+    }
+};
\ No newline at end of file
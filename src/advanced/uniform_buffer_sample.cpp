@@ -0,0 +1,108 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+
+#include <GL/glew.h>
+
+#include "opengl/context.hpp"
+#include "opengl/errors.hpp"
+#include "opengl/vertex_array.hpp"
+#include "opengl/shader.hpp"
+#include "opengl/uniform_buffer.hpp"
+#include "opengl/shader_watcher.hpp"
+
+int main(int argc, char** argv)
+{
+    ContextSettings settings = context_settings_from_args(argc, argv);
+    settings.title = "Uniform Buffers";
+
+    Context context(settings);
+    if (!context.valid)
+        return 1;
+
+    gl_init_errors();
+
+    float vertexes[] = {
+        // x    y      // color
+        -0.3f, -0.3f,  1.0f, 0.0f, 0.0f, 1.0f,
+        +0.0f, +0.3f,  0.0f, 0.0f, 1.0f, 1.0f,
+        +0.3f, -0.3f,  0.0f, 1.0f, 0.0f, 1.0f,
+    };
+
+    unsigned int indices[] = {
+        0, 1, 2
+    };
+
+    VertexArray va;
+
+    va.bind();
+
+    VertexBuffer* vb = va.bind_vertex_buffer(vertexes, sizeof(vertexes));
+    // Position, then color.
+    using Layout = VertexLayout<Attr<float, 2>, Attr<float, 4>>;
+    static_assert(Layout::stride == sizeof(vertexes[0]) * 6);
+
+    vb->set_layout<Layout>();
+
+    IndexBuffer* ib = va.bind_index_buffer(indices, sizeof(indices) / sizeof(indices[0]));
+    (void)ib;
+
+    va.unbind_all();
+
+    // Same layout as the `Frame` block in the shaders.
+    UniformBlockLayout frame_layout;
+    UniformBlockMember u_tint = frame_layout.add("u_Tint", UniformType::Vec4);
+    UniformBlockMember u_offset = frame_layout.add("u_Offset", UniformType::Vec2);
+    UniformBlockMember u_time = frame_layout.add("u_Time", UniformType::Float);
+
+    UniformBuffer frame(frame_layout, 0);
+
+    // Both shaders read from the same block, so updating it once
+    // per frame updates both of them.
+    Shader flat_shader("resources/uniform_block_color.glsl");
+    Shader color_shader("resources/uniform_block_vertex_color.glsl");
+    if (!flat_shader.valid || !color_shader.valid)
+        return 1;
+
+    flat_shader.bind_uniform_block("Frame", frame);
+    color_shader.bind_uniform_block("Frame", frame);
+
+    // Edit the shaders while this runs to see them reloaded.
+    flat_shader.watch();
+    color_shader.watch();
+
+    float t = 0;
+
+    while (!context.should_close()) {
+        shader_watcher().update();
+
+        gl(Clear, GL_COLOR_BUFFER_BIT);
+
+        frame.set_vec4(u_tint, 0.5f, 0.3f, 0.8f, 1.0f);
+        frame.set_vec2(u_offset, 0.4f, 0.0f);
+        frame.set_float(u_time, t);
+        frame.upload();
+
+        va.bind();
+
+        flat_shader.bind();
+        va.draw_elements(3);
+
+        color_shader.bind();
+        va.draw_elements(3);
+
+        color_shader.unbind();
+        va.unbind();
+
+        t += 0.02f;
+
+        gl_frame_check_errors();
+
+        context.swap_buffers();
+        context.poll_events();
+    }
+
+    context.report_frame_times();
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+#include "bench_common.hpp"
+
+#include "../advanced/opengl/errors.hpp"
+#include "../advanced/opengl/batch_renderer.hpp"
+#include "../advanced/opengl/shader.hpp"
+
+// Draws the same colored quads with:
+//  - batched:    `BatchRenderer`;
+//  - per-object: one `VertexArray` per quad, drawn like in
+//                abstraction_sample.cpp (bind, draw, unbind).
+
+const float QUAD_SIZE = 0.004f;
+
+static void quad_position(std::size_t i, float& x, float& y)
+{
+    x = (float)(i % 500) / 250.0f - 1.0f;
+    y = (float)(i / 500 % 500) / 250.0f - 1.0f;
+}
+
+static void run_batched(std::size_t frames, std::size_t quad_count)
+{
+    Shader shader("resources/default_vertex_color.glsl");
+    BatchRenderer batch;
+
+    double start = bench_now();
+
+    for (std::size_t frame = 0; frame < frames; ++frame) {
+        gl(Clear, GL_COLOR_BUFFER_BIT);
+
+        shader.bind();
+        batch.begin_frame();
+
+        for (std::size_t i = 0; i < quad_count; ++i) {
+            float x, y;
+            quad_position(i, x, y);
+            batch.submit_quad(x, y, QUAD_SIZE, QUAD_SIZE, 
+                               (float)(i % 7) / 7.0f, 0.3f, 0.8f, 1.0f);
+        }
+
+        batch.end_frame();
+        shader.unbind();
+
+        gl_frame_check_errors();
+        bench_swap_buffers();
+    }
+
+    glFinish();
+
+    double elapsed = bench_now() - start;
+
+    std::cout << "batched:" << std::endl;
+    std::cout << "  ms/frame:        " << elapsed * 1000.0 / frames << std::endl;
+    std::cout << "  draws/frame:     " << batch.get_stats().draw_calls << std::endl;
+    std::cout << "  vertices/frame:  " << batch.get_stats().vertices << std::endl;
+}
+
+static void run_per_object(std::size_t frames, std::size_t quad_count)
+{
+    Shader shader("resources/default_fragment_color.glsl");
+    UniformHandle u_color = shader.get_uniform("u_Color");
+
+    unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+
+    // Moving a vertex array is cheap, but there's no need to.
+    std::vector<VertexArray> objects;
+    objects.reserve(quad_count);
+
+    for (std::size_t i = 0; i < quad_count; ++i) {
+        float x, y;
+        quad_position(i, x, y);
+
+        float vertexes[] = {
+            x, y,
+            x + QUAD_SIZE, y,
+            x + QUAD_SIZE, y + QUAD_SIZE,
+            x, y + QUAD_SIZE,
+        };
+
+        VertexArray& va = objects.emplace_back();
+        va.bind();
+
+        VertexBuffer* vb = va.bind_vertex_buffer(vertexes, sizeof(vertexes));
+        vb->set_attribute_layout(0, 2, GL_FLOAT, GL_FALSE, sizeof(vertexes[0]) * 2, 0);
+        va.bind_index_buffer(indices, 6);
+
+        va.unbind_all();
+    }
+
+    double start = bench_now();
+
+    for (std::size_t frame = 0; frame < frames; ++frame) {
+        gl(Clear, GL_COLOR_BUFFER_BIT);
+
+        for (std::size_t i = 0; i < quad_count; ++i) {
+            shader.bind();
+            shader.set_uniform_4f(u_color, (float)(i % 7) / 7.0f, 0.3f, 0.8f, 1.0f);
+
+            objects[i].bind();
+            objects[i].draw_elements(6);
+            objects[i].unbind();
+
+            shader.unbind();
+        }
+
+        gl_frame_check_errors();
+        bench_swap_buffers();
+    }
+
+    glFinish();
+
+    double elapsed = bench_now() - start;
+
+    std::cout << "per-object:" << std::endl;
+    std::cout << "  ms/frame:        " << elapsed * 1000.0 / frames << std::endl;
+    std::cout << "  draws/frame:     " << quad_count << std::endl;
+    std::cout << "  vertices/frame:  " << quad_count * 4 << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    Context context(bench_context_settings(argc, argv));
+    if (!bench_init_context(context))
+        return 1;
+
+    std::size_t frames = argc > 1 ? std::atol(argv[1]) : 100;
+    std::size_t quad_count = argc > 2 ? std::atol(argv[2]) : 100000;
+
+    gl_init_errors();
+
+    run_batched(frames, quad_count);
+    run_per_object(frames, quad_count);
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <iostream>
+
+#include "../advanced/opengl/context.hpp"
+
+// Benchmarks render into an invisible window so they can be run
+// next to other work, or without a display with `--headless`.
+// Run them from the root of the project (they load shaders from
+// `resources/`) and with `LIBGL_ALWAYS_SOFTWARE=1` to force Mesa's
+// llvmpipe.
+inline Context* bench_context = nullptr;
+
+// Takes the context flags out of `argv`, so the benchmarks can
+// read their own arguments by position.
+inline ContextSettings bench_context_settings(int& argc, char** argv)
+{
+    ContextSettings settings = context_settings_from_args(argc, argv);
+    settings.title = "Benchmark";
+    settings.visible = false;
+    settings.vsync = false;
+
+    return settings;
+}
+
+// Must be called first thing in `main`, with a context created from
+// `bench_context_settings` that outlives everything else.
+inline bool bench_init_context(Context& context)
+{
+    if (!context.valid)
+        return false;
+
+    bench_context = &context;
+
+    std::cout << "INFO: renderer: " << glGetString(GL_RENDERER)
+              << " (" << context_backend_name(context.get_backend()) << ")" << std::endl;
+
+    return true;
+}
+
+inline void bench_swap_buffers()
+{
+    bench_context->swap_buffers();
+}
+
+inline double bench_now()
+{
+    using clock = std::chrono::steady_clock;
+    return std::chrono::duration<double>(clock::now().time_since_epoch()).count();
+}
\ No newline at end of file
@@ -0,0 +1,327 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <cstdlib>
+#include <cstdint>
+
+#include "bench_common.hpp"
+
+#include "../advanced/opengl/errors.hpp"
+#include "../advanced/opengl/vertex_array.hpp"
+#include "../advanced/opengl/shader.hpp"
+#include "../advanced/opengl/draw_queue.hpp"
+#include "../advanced/opengl/parallel.hpp"
+
+// Draws objects using a few programs, vertex arrays and materials, in an
+// order that has nothing to do with them (like a scene graph would):
+//  - direct: bind, set uniforms and draw object by object (the state
+//            cache skips binding what's already bound);
+//  - queue:  recorded on several threads into a `DrawQueue`, sorted
+//            by key and submitted.
+// Then sorts a million keys on 1, 2, 4... threads, and with
+// `std::stable_sort` for reference.
+
+const std::size_t SHADER_COUNT = 4;
+const std::size_t VERTEX_ARRAY_COUNT = 8;
+const std::size_t MATERIAL_COUNT = 16;
+
+static std::uint32_t hash(std::uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352d;
+    x ^= x >> 15;
+    x *= 0x846ca68b;
+    x ^= x >> 16;
+    return x;
+}
+
+struct Object {
+    std::size_t shader;
+    std::size_t vertex_array;
+    std::size_t material;
+    float x, y;
+    float depth;
+};
+
+struct Scene {
+    std::vector<Shader> shaders;
+    std::vector<VertexArray> vertex_arrays;
+    std::vector<UniformHandle> u_offset;
+    std::vector<UniformHandle> u_color;
+    std::vector<Object> objects;
+};
+
+static void material_color(std::size_t material, float color[4])
+{
+    color[0] = (float)(material % 4) / 4.0f;
+    color[1] = (float)(material / 4) / 4.0f;
+    color[2] = 0.8f;
+    color[3] = 1.0f;
+}
+
+static void record(DrawRecorder& recorder, Scene& scene, std::size_t begin, std::size_t end)
+{
+    for (std::size_t i = begin; i < end; ++i) {
+        const Object& object = scene.objects[i];
+        Shader& shader = scene.shaders[object.shader];
+        const VertexArray& va = scene.vertex_arrays[object.vertex_array];
+
+        float color[4];
+        material_color(object.material, color);
+
+        std::uint64_t key = make_draw_key(0, shader.get_id(), va.get_id(),
+                                          object.material, object.depth);
+
+        DrawItem& item = recorder.draw(key, shader, va, 6);
+        item.set_uniform(scene.u_offset[object.shader], 2, object.x, object.y);
+        item.set_uniform(scene.u_color[object.shader], 4, color[0], color[1], color[2], color[3]);
+    }
+}
+
+static double run_direct(std::size_t frames, Scene& scene)
+{
+    double start = bench_now();
+
+    for (std::size_t frame = 0; frame < frames; ++frame) {
+        gl(Clear, GL_COLOR_BUFFER_BIT);
+
+        for (const Object& object : scene.objects) {
+            Shader& shader = scene.shaders[object.shader];
+            const VertexArray& va = scene.vertex_arrays[object.vertex_array];
+
+            float color[4];
+            material_color(object.material, color);
+
+            shader.bind();
+            va.bind();
+            shader.set_uniform_2f(scene.u_offset[object.shader], object.x, object.y);
+            shader.set_uniform_4f(scene.u_color[object.shader],
+                                  color[0], color[1], color[2], color[3]);
+            va.draw_elements(6);
+        }
+
+        gl_frame_check_errors();
+        bench_swap_buffers();
+    }
+
+    glFinish();
+
+    return bench_now() - start;
+}
+
+static double run_queue(std::size_t frames, Scene& scene, DrawQueue& queue,
+                        double& record_time, double& sort_time)
+{
+    std::size_t threads = queue.get_recorder_count();
+    std::size_t count = scene.objects.size();
+
+    record_time = 0;
+    sort_time = 0;
+
+    double start = bench_now();
+
+    for (std::size_t frame = 0; frame < frames; ++frame) {
+        double record_start = bench_now();
+
+        parallel_for(threads, threads, [&](std::size_t thread) {
+            record(queue.get_recorder(thread), scene,
+                   count * thread / threads, count * (thread + 1) / threads);
+        });
+
+        double sort_start = bench_now();
+        queue.sort();
+        double sort_end = bench_now();
+
+        record_time += sort_start - record_start;
+        sort_time += sort_end - sort_start;
+
+        gl(Clear, GL_COLOR_BUFFER_BIT);
+        queue.submit();
+
+        gl_frame_check_errors();
+        bench_swap_buffers();
+
+        if (frame + 1 < frames)
+            queue.clear();
+    }
+
+    glFinish();
+
+    return bench_now() - start;
+}
+
+static bool check_sorted(const DrawQueue& queue)
+{
+    for (std::size_t i = 1; i < queue.get_size(); ++i) {
+        if (queue.get_item(i - 1).key > queue.get_item(i).key)
+            return false;
+    }
+
+    return true;
+}
+
+static void report_changes(const char* label, const DrawStateChanges& changes)
+{
+    std::cout << "  " << label << " programs: " << changes.shaders
+              << ", vertex arrays: " << changes.vertex_arrays
+              << ", materials: " << changes.materials << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    Context context(bench_context_settings(argc, argv));
+    if (!bench_init_context(context))
+        return 1;
+
+    std::size_t frames = argc > 1 ? std::atol(argv[1]) : 100;
+    std::size_t object_count = argc > 2 ? std::atol(argv[2]) : 20000;
+    std::size_t record_threads = argc > 3 ? std::atol(argv[3]) : 4;
+    unsigned int max_threads = argc > 4 ? std::atol(argv[4]) : 8;
+
+    gl_init_errors();
+
+    Scene scene;
+    scene.shaders.reserve(SHADER_COUNT);
+
+    for (std::size_t i = 0; i < SHADER_COUNT; ++i) {
+        Shader& shader = scene.shaders.emplace_back("resources/offset_color.glsl",
+                                                    std::vector<std::string> {
+                                                        "VARIANT " + std::to_string(i) });
+        if (!shader.valid)
+            return 1;
+
+        shader.bind();
+        shader.set_uniform_1f("u_Scale", 1.0f);
+
+        scene.u_offset.push_back(shader.get_uniform("u_Offset"));
+        scene.u_color.push_back(shader.get_uniform("u_Color"));
+    }
+
+    scene.vertex_arrays.reserve(VERTEX_ARRAY_COUNT);
+
+    for (std::size_t i = 0; i < VERTEX_ARRAY_COUNT; ++i) {
+        float size = 0.002f * (i + 1);
+        float vertexes[] = {
+            -size, -size,
+            +size, -size,
+            +size, +size,
+            -size, +size,
+        };
+
+        unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+
+        VertexArray& va = scene.vertex_arrays.emplace_back();
+        va.bind();
+
+        VertexBuffer* vb = va.bind_vertex_buffer(vertexes, sizeof(vertexes));
+        vb->set_layout<VertexLayout<Attr<float, 2>>>();
+        va.bind_index_buffer(indices, 6);
+
+        va.unbind_all();
+    }
+
+    for (std::uint32_t i = 0; i < object_count; ++i) {
+        std::uint32_t h = hash(i);
+
+        scene.objects.push_back({
+            h % SHADER_COUNT,
+            (h >> 8) % VERTEX_ARRAY_COUNT,
+            (h >> 16) % MATERIAL_COUNT,
+            (float)(hash(h) % 2000) / 1000.0f - 1.0f,
+            (float)(hash(h + 1) % 2000) / 1000.0f - 1.0f,
+            (float)(hash(h + 2) % 1000) / 1000.0f,
+        });
+    }
+
+    std::cout << "objects: " << object_count << ", programs: " << SHADER_COUNT
+              << ", vertex arrays: " << VERTEX_ARRAY_COUNT
+              << ", materials: " << MATERIAL_COUNT << std::endl;
+
+    /*                  *
+     *   Draw a scene   *
+     *                  */
+
+    // The first frames are slower whatever draws them.
+    run_direct(frames / 10 + 1, scene);
+
+    double direct = run_direct(frames, scene);
+
+    DrawQueue queue(record_threads);
+    double record_time, sort_time;
+    double queued = run_queue(frames, scene, queue, record_time, sort_time);
+
+    if (!check_sorted(queue)) {
+        std::cerr << "ERROR: draws are not sorted" << std::endl;
+        return 1;
+    }
+
+    const DrawQueueStats& stats = queue.get_stats();
+
+    std::cout << "state changes per frame:" << std::endl;
+    report_changes("unsorted:", stats.unsorted);
+    report_changes("sorted:  ", stats.sorted);
+
+    std::cout << "direct:" << std::endl;
+    std::cout << "  ms/frame: " << direct * 1000.0 / frames << std::endl;
+    std::cout << "queue (" << record_threads << " recording threads):" << std::endl;
+    std::cout << "  ms/frame: " << queued * 1000.0 / frames << std::endl;
+    std::cout << "  record:   " << record_time * 1000.0 / frames << " ms" << std::endl;
+    std::cout << "  sort:     " << sort_time * 1000.0 / frames << " ms" << std::endl;
+
+    /*                 *
+     *   Sort alone    *
+     *                 */
+
+    std::size_t sort_count = 1000000;
+    std::vector<std::uint64_t> keys(sort_count);
+
+    for (std::uint32_t i = 0; i < sort_count; ++i) {
+        const Object& object = scene.objects[i % scene.objects.size()];
+        keys[i] = make_draw_key(hash(i) % 4, object.shader, object.vertex_array,
+                                object.material, object.depth);
+    }
+
+    std::cout << "sorting " << sort_count << " items:" << std::endl;
+
+    {
+        std::vector<std::pair<std::uint64_t, std::uint32_t>> pairs(sort_count);
+        for (std::uint32_t i = 0; i < sort_count; ++i) {
+            pairs[i] = { keys[i], i };
+        }
+
+        double start = bench_now();
+        std::stable_sort(pairs.begin(), pairs.end(), [](const auto& a, const auto& b) {
+            return a.first < b.first;
+        });
+        double elapsed = bench_now() - start;
+
+        std::cout << "  std::stable_sort: " << elapsed * 1000.0 << " ms" << std::endl;
+    }
+
+    for (unsigned int threads = 1; threads <= max_threads; threads *= 2) {
+        DrawQueue big_queue(1, threads);
+        DrawRecorder& recorder = big_queue.get_recorder(0);
+
+        for (std::uint32_t i = 0; i < sort_count; ++i) {
+            const Object& object = scene.objects[i % scene.objects.size()];
+            recorder.draw(keys[i], scene.shaders[object.shader],
+                          scene.vertex_arrays[object.vertex_array], 6);
+        }
+
+        double start = bench_now();
+        big_queue.sort();
+        double elapsed = bench_now() - start;
+
+        if (!check_sorted(big_queue)) {
+            std::cerr << "ERROR: draws are not sorted" << std::endl;
+            return 1;
+        }
+
+        std::cout << "  " << threads << " threads:        " << elapsed * 1000.0 << " ms"
+                  << std::endl;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include <iostream>
+#include <cstdlib>
+
+#include "bench_common.hpp"
+
+#include "../advanced/opengl/errors.hpp"
+#include "../advanced/opengl/vertex_array.hpp"
+#include "../advanced/opengl/shader.hpp"
+
+// Measures the overhead of the `gl()` macro under the error policy
+// this binary was compiled with. See `build.sh` for the variants.
+int main(int argc, char** argv)
+{
+    Context context(bench_context_settings(argc, argv));
+    if (!bench_init_context(context))
+        return 1;
+
+    std::size_t frames = argc > 1 ? std::atol(argv[1]) : 1000;
+    const std::size_t iterations_per_frame = 1000;
+    const std::size_t calls_per_iteration = 4;
+
+    gl_init_errors();
+
+    VertexArray va;
+    Shader shader("resources/default_fragment_color.glsl");
+    if (!shader.valid)
+        return 1;
+
+    GLint program;
+    shader.bind();
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    GLint location = glGetUniformLocation(program, "u_Color");
+    shader.unbind();
+
+    double start = bench_now();
+
+    for (std::size_t frame = 0; frame < frames; ++frame) {
+        for (std::size_t i = 0; i < iterations_per_frame; ++i) {
+            gl(UseProgram, program);
+            gl(Uniform4f, location, (float)(i & 1), 0.3f, 0.8f, 1.0f);
+            va.bind();
+            va.unbind();
+        }
+
+        gl_frame_check_errors();
+    }
+
+    glFinish();
+
+    double elapsed = bench_now() - start;
+    double calls = (double)(frames * iterations_per_frame * calls_per_iteration);
+
+    std::cout << "policy: " << gl_error_policy_name() << std::endl;
+    std::cout << "  calls:        " << (std::size_t)calls << std::endl;
+    std::cout << "  elapsed:      " << elapsed << " s" << std::endl;
+    std::cout << "  calls/second: " << (std::size_t)(calls / elapsed) << std::endl;
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,258 @@
+#include <iostream>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cstdint>
+
+#include "bench_common.hpp"
+
+#include "../advanced/opengl/errors.hpp"
+#include "../advanced/opengl/vertex_array.hpp"
+#include "../advanced/opengl/shader.hpp"
+#include "../advanced/opengl/batch_renderer.hpp"
+#include "../advanced/opengl/command_buffer.hpp"
+#include "../advanced/opengl/draw_queue.hpp"
+#include "../advanced/opengl/frame_arena.hpp"
+#include "../advanced/opengl/pool_allocator.hpp"
+
+// Counts the heap allocations made while drawing frames, once the first
+// ones have grown everything to its steady state size. Every frame:
+//  - simulates objects into the frame arena;
+//  - records them into a `DrawQueue`, sorts and submits it;
+//  - records and executes a `CommandBuffer`;
+//  - sets a uniform by name and draws;
+//  - draws quads with the `BatchRenderer`;
+//  - creates and deletes a vertex array with its buffers.
+// Fails if there is any. Only `operator new` is counted: the driver
+// allocates with `malloc`, which is out of our hands.
+
+const std::size_t WARMUP_FRAMES = 10;
+
+static std::atomic<bool> counting = false;
+static std::atomic<std::size_t> heap_allocations = 0;
+
+static void* allocate(std::size_t size, std::size_t alignment)
+{
+    if (counting.load(std::memory_order_relaxed))
+        heap_allocations++;
+
+    // `aligned_alloc` wants a multiple of the alignment.
+    size = (size + alignment - 1) / alignment * alignment;
+
+    void* memory = alignment <= alignof(std::max_align_t) ? std::malloc(size ? size : 1)
+                                                          : std::aligned_alloc(alignment, size);
+    if (!memory)
+        throw std::bad_alloc();
+
+    return memory;
+}
+
+void* operator new(std::size_t size)
+{
+    return allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t size)
+{
+    return allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return allocate(size, (std::size_t)alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return allocate(size, (std::size_t)alignment);
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+
+struct Object {
+    float x, y;
+    float depth;
+};
+
+struct Scene {
+    Shader& shader;
+    Shader& batch_shader;
+    UniformHandle u_offset;
+    UniformHandle u_color;
+    VertexArray& quad;
+    BatchRenderer& batch;
+    DrawQueue& queue;
+    CommandBuffer& commands;
+    std::size_t object_count;
+};
+
+static const float QUAD_VERTICES[] = {
+    -0.01f, -0.01f,
+    +0.01f, -0.01f,
+    +0.01f, +0.01f,
+    -0.01f, +0.01f,
+};
+
+static const unsigned int QUAD_INDICES[] = { 0, 1, 2, 2, 3, 0 };
+
+static void create_quad(VertexArray& va)
+{
+    va.bind();
+
+    VertexBuffer* vb = va.bind_vertex_buffer(QUAD_VERTICES, sizeof(QUAD_VERTICES));
+    vb->set_layout<VertexLayout<Attr<float, 2>>>();
+    va.bind_index_buffer(QUAD_INDICES, 6);
+
+    va.unbind_all();
+}
+
+static void draw_frame(Scene& scene, std::size_t frame)
+{
+    gl(Clear, GL_COLOR_BUFFER_BIT);
+
+    // Simulated into the arena, gone at the end of the next frame.
+    Object* objects = frame_arena().allocate_array<Object>(scene.object_count);
+
+    for (std::size_t i = 0; i < scene.object_count; ++i) {
+        float t = (float)((frame + i) % 200) / 100.0f - 1.0f;
+        objects[i] = { t, (float)i / scene.object_count * 2.0f - 1.0f, (float)(i % 7) / 7.0f };
+    }
+
+    DrawRecorder& recorder = scene.queue.get_recorder(0);
+    for (std::size_t i = 0; i < scene.object_count; ++i) {
+        std::uint64_t key = make_draw_key(0, scene.shader.get_id(), scene.quad.get_id(),
+                                          i % 4, objects[i].depth);
+
+        DrawItem& item = recorder.draw(key, scene.shader, scene.quad, 6);
+        item.set_uniform(scene.u_offset, 2, objects[i].x, objects[i].y);
+        item.set_uniform(scene.u_color, 4, 0.2f, 0.4f, (float)(i % 4) / 4.0f, 1.0f);
+    }
+
+    scene.queue.sort();
+    scene.queue.submit();
+    scene.queue.clear();
+
+    scene.commands.bind_shader(scene.shader);
+    scene.commands.bind_vertex_array(scene.quad);
+    scene.commands.set_uniform_2f(scene.shader, scene.u_offset, 0.5f, 0.5f);
+    scene.commands.set_uniform_4f(scene.shader, scene.u_color, 1.0f, 0.0f, 0.0f, 1.0f);
+    scene.commands.draw_elements(scene.quad, 6);
+    scene.commands.execute();
+    scene.commands.reset();
+
+    scene.shader.bind();
+    scene.shader.set_uniform_2f("u_Offset", -0.5f, -0.5f);
+    scene.shader.set_uniform_4f("u_Color", 0.0f, 1.0f, 0.0f, 1.0f);
+    scene.quad.bind();
+    scene.quad.draw_elements(6);
+
+    scene.batch_shader.bind();
+    scene.batch.begin_frame();
+    for (std::size_t i = 0; i < scene.object_count; ++i) {
+        scene.batch.submit_quad(objects[i].x, -objects[i].y, 0.01f, 0.01f,
+                                1.0f, 1.0f, objects[i].depth, 1.0f);
+    }
+    scene.batch.end_frame();
+
+    {
+        VertexArray mesh;
+        create_quad(mesh);
+
+        scene.shader.bind();
+        mesh.bind();
+        mesh.draw_elements(6);
+    }
+
+    gl_frame_check_errors();
+    bench_swap_buffers();
+}
+
+int main(int argc, char** argv)
+{
+    ContextSettings settings = bench_context_settings(argc, argv);
+
+    std::size_t frames = argc > 1 ? std::atol(argv[1]) : 100;
+    std::size_t object_count = argc > 2 ? std::atol(argv[2]) : 1000;
+
+    // The frame times are reserved from it.
+    settings.max_frames = WARMUP_FRAMES + frames;
+
+    Context context(settings);
+    if (!bench_init_context(context))
+        return 1;
+
+    gl_init_errors();
+
+    Shader shader("resources/offset_color.glsl");
+    Shader batch_shader("resources/default_vertex_color.glsl");
+    if (!shader.valid || !batch_shader.valid)
+        return 1;
+
+    shader.bind();
+    shader.set_uniform_1f("u_Scale", 1.0f);
+
+    VertexArray quad;
+    create_quad(quad);
+
+    BatchRenderer batch;
+    DrawQueue queue(1);
+    CommandBuffer commands;
+
+    Scene scene = {
+        shader, batch_shader,
+        shader.get_uniform("u_Offset"), shader.get_uniform("u_Color"),
+        quad, batch, queue, commands, object_count,
+    };
+
+    // Vectors, pools and the arena grow to what a frame needs.
+    for (std::size_t frame = 0; frame < WARMUP_FRAMES; ++frame) {
+        draw_frame(scene, frame);
+    }
+
+    PoolStats pool_before = block_pool_stats();
+    std::size_t overflows_before = frame_arena().get_stats().overflows;
+
+    counting = true;
+    double start = bench_now();
+
+    for (std::size_t frame = 0; frame < frames; ++frame) {
+        draw_frame(scene, WARMUP_FRAMES + frame);
+    }
+
+    glFinish();
+
+    double elapsed = bench_now() - start;
+    counting = false;
+
+    PoolStats pool = block_pool_stats();
+    const FrameArenaStats& arena = frame_arena().get_stats();
+
+    std::cout << "frames: " << frames << ", objects: " << object_count << std::endl;
+    std::cout << "ms/frame: " << elapsed * 1000.0 / frames << std::endl;
+    std::cout << "heap allocations per frame: " << (double)heap_allocations / frames
+              << std::endl;
+    std::cout << "frame arena:" << std::endl;
+    std::cout << "  peak:      " << arena.peak_bytes << " bytes" << std::endl;
+    std::cout << "  capacity:  " << arena.capacity << " bytes" << std::endl;
+    std::cout << "  overflows: " << arena.overflows - overflows_before << std::endl;
+    std::cout << "block pools:" << std::endl;
+    std::cout << "  allocations per frame: "
+              << (double)(pool.allocations - pool_before.allocations) / frames << std::endl;
+    std::cout << "  slabs:                 " << pool.slabs << " ("
+              << pool.slabs - pool_before.slabs << " while counting)" << std::endl;
+
+    if (heap_allocations != 0) {
+        std::cerr << "ERROR: " << heap_allocations << " heap allocations in "
+                  << frames << " frames" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
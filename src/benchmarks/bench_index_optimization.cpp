@@ -0,0 +1,152 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+
+#include "bench_common.hpp"
+
+#include "../advanced/opengl/errors.hpp"
+#include "../advanced/opengl/vertex_array.hpp"
+#include "../advanced/opengl/vertex_layout.hpp"
+#include "../advanced/opengl/mesh_optimizer.hpp"
+#include "../advanced/opengl/shader.hpp"
+
+// Draws a grid mesh whose triangles and vertices are shuffled (like
+// the output of a careless exporter), before and after running it
+// through the mesh optimizer, with 32 bit and auto-selected indices.
+
+struct Vertex {
+    float x, y;
+    float r, g, b, a;
+};
+
+using Layout = VertexLayout<Attr<float, 2>, Attr<float, 4>>;
+VERTEX_LAYOUT_CHECK(Layout, Vertex, x, r);
+
+struct Mesh {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+};
+
+static Mesh make_shuffled_grid(std::size_t side)
+{
+    Mesh mesh;
+    std::mt19937 random(42);
+
+    std::vector<unsigned int> order(side * side);
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), random);
+
+    mesh.vertices.resize(side * side);
+    for (std::size_t y = 0; y < side; ++y) {
+        for (std::size_t x = 0; x < side; ++x) {
+            float fx = (float)x / (side - 1);
+            float fy = (float)y / (side - 1);
+            mesh.vertices[order[y * side + x]] = { fx * 2.0f - 1.0f, fy * 2.0f - 1.0f,
+                                                   fx, fy, 0.5f, 1.0f };
+        }
+    }
+
+    std::vector<unsigned int> quads((side - 1) * (side - 1));
+    for (std::size_t i = 0; i < quads.size(); ++i) {
+        quads[i] = i;
+    }
+    std::shuffle(quads.begin(), quads.end(), random);
+
+    for (unsigned int quad : quads) {
+        std::size_t x = quad % (side - 1);
+        std::size_t y = quad / (side - 1);
+
+        unsigned int a = order[y * side + x];
+        unsigned int b = order[y * side + x + 1];
+        unsigned int c = order[(y + 1) * side + x + 1];
+        unsigned int d = order[(y + 1) * side + x];
+
+        mesh.indices.insert(mesh.indices.end(), { a, b, c, c, d, a });
+    }
+
+    return mesh;
+}
+
+static void run(const char* label, const Mesh& mesh, GLenum type, std::size_t frames)
+{
+    VertexArray va;
+    va.bind();
+
+    VertexBuffer* vb = va.bind_vertex_buffer(mesh.vertices.data(),
+                                              mesh.vertices.size() * sizeof(Vertex));
+    vb->set_layout<Layout>();
+
+    IndexBuffer* ib = va.bind_index_buffer(mesh.indices.data(), mesh.indices.size(), type);
+
+    double start = bench_now();
+
+    for (std::size_t frame = 0; frame < frames; ++frame) {
+        gl(Clear, GL_COLOR_BUFFER_BIT);
+        va.draw_elements(mesh.indices.size());
+
+        gl_frame_check_errors();
+        bench_swap_buffers();
+    }
+
+    glFinish();
+
+    double elapsed = bench_now() - start;
+
+    std::cout << label << ":" << std::endl;
+    std::cout << "  index bytes:   " << ib->get_count() * IndexBuffer::get_type_size(ib->get_type())
+              << std::endl;
+    std::cout << "  ms/frame:      " << elapsed * 1000.0 / frames << std::endl;
+
+    va.unbind();
+}
+
+int main(int argc, char** argv)
+{
+    Context context(bench_context_settings(argc, argv));
+    if (!bench_init_context(context))
+        return 1;
+
+    std::size_t frames = argc > 1 ? std::atol(argv[1]) : 50;
+    // 250x250 vertices fit in 16 bit indices.
+    std::size_t side = argc > 2 ? std::atol(argv[2]) : 250;
+
+    gl_init_errors();
+
+    Mesh mesh = make_shuffled_grid(side);
+    report_vertex_cache("shuffled", mesh.indices.data(), mesh.indices.size(),
+                        mesh.vertices.size());
+
+    Mesh optimized = mesh;
+
+    double optimize_start = bench_now();
+    optimize_vertex_cache(optimized.indices.data(), optimized.indices.size(),
+                          optimized.vertices.size());
+    std::size_t vertex_count = optimize_vertex_fetch(optimized.indices.data(),
+                                                     optimized.indices.size(),
+                                                     optimized.vertices.data(),
+                                                     optimized.vertices.size(),
+                                                     sizeof(Vertex));
+    optimized.vertices.resize(vertex_count);
+    double optimize_time = bench_now() - optimize_start;
+
+    report_vertex_cache("optimized", optimized.indices.data(), optimized.indices.size(),
+                        optimized.vertices.size());
+    std::cout << "INFO: optimized " << optimized.indices.size() / 3 << " triangles in "
+              << optimize_time * 1000.0 << " ms" << std::endl;
+
+    Shader shader("resources/default_vertex_color.glsl");
+    shader.bind();
+
+    run("shuffled, uint", mesh, GL_UNSIGNED_INT, frames);
+    run("shuffled, auto", mesh, GL_NONE, frames);
+    run("optimized, uint", optimized, GL_UNSIGNED_INT, frames);
+    run("optimized, auto", optimized, GL_NONE, frames);
+
+    shader.unbind();
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,305 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstdint>
+
+#include "bench_common.hpp"
+
+#include "../advanced/opengl/errors.hpp"
+#include "../advanced/opengl/vertex_array.hpp"
+#include "../advanced/opengl/shader.hpp"
+#include "../advanced/opengl/mesh.hpp"
+#include "../advanced/opengl/draw_indirect_buffer.hpp"
+#include "../advanced/opengl/frame_arena.hpp"
+
+// Draws thousands of distinct meshes (small polygons), each moving every
+// frame:
+//  - direct:   a vertex array per mesh, and for each one a bind, two
+//              uniforms and a `glDrawElements`;
+//  - indirect: every mesh in one vertex array, the positions and colors
+//              in a per-draw buffer (read through `base_instance`), and
+//              a single `glMultiDrawElementsIndirect`.
+// Both must draw the same image, also when some meshes are drawn
+// several times (instances, each with its own per-draw entry).
+
+using PositionLayout = VertexLayout<Attr<float, 2>>;
+
+struct DrawData {
+    float x, y;
+    float r, g, b, a;
+};
+
+using DrawDataLayout = VertexLayout<Attr<float, 2>, Attr<float, 4>>;
+
+static std::uint32_t hash(std::uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352d;
+    x ^= x >> 15;
+    x *= 0x846ca68b;
+    x ^= x >> 16;
+    return x;
+}
+
+static void make_polygon(std::uint32_t seed, MeshData& mesh)
+{
+    unsigned int sides = 3 + hash(seed) % 6;
+    float radius = 0.004f + (float)(hash(seed + 1) % 100) / 100.0f * 0.006f;
+
+    mesh.attributes.assign(PositionLayout::attributes.begin(), PositionLayout::attributes.end());
+    mesh.stride = PositionLayout::stride;
+    mesh.vertex_count = sides;
+    mesh.vertices.resize(sides * mesh.stride);
+
+    float* positions = (float*)mesh.vertices.data();
+    for (unsigned int i = 0; i < sides; ++i) {
+        float angle = 6.2831853f * i / sides;
+        positions[i * 2 + 0] = radius * std::cos(angle);
+        positions[i * 2 + 1] = radius * std::sin(angle);
+    }
+
+    for (unsigned int i = 1; i + 1 < sides; ++i) {
+        mesh.indices.insert(mesh.indices.end(), { 0, i, i + 1 });
+    }
+}
+
+static DrawData draw_data(std::size_t object, std::size_t frame)
+{
+    std::uint32_t h = hash(object);
+    float x = (float)(h % 2000) / 1000.0f - 1.0f;
+    float y = (float)((h >> 11) % 2000) / 1000.0f - 1.0f;
+    float t = (float)(frame % 100) / 1000.0f;
+
+    return { x + t, y - t, (float)(h % 4) / 4.0f, (float)((h >> 2) % 4) / 4.0f, 0.8f, 1.0f };
+}
+
+struct DirectScene {
+    Shader& shader;
+    UniformHandle u_offset;
+    UniformHandle u_color;
+    std::vector<VertexArray> meshes;
+    std::vector<std::size_t> index_counts;
+    // How many times each mesh is drawn, once if empty.
+    std::vector<std::size_t> instances;
+};
+
+struct IndirectScene {
+    Shader& shader;
+    VertexArray& va;
+    VertexBuffer* per_draw;
+    DrawIndirectBuffer& commands;
+};
+
+static void draw_direct(DirectScene& scene, std::size_t frame)
+{
+    gl(Clear, GL_COLOR_BUFFER_BIT);
+
+    scene.shader.bind();
+
+    // Numbered like `DrawIndirectBuffer` numbers instances.
+    std::size_t instance = 0;
+
+    for (std::size_t i = 0; i < scene.meshes.size(); ++i) {
+        std::size_t instances = scene.instances.empty() ? 1 : scene.instances[i];
+
+        scene.meshes[i].bind();
+
+        for (std::size_t j = 0; j < instances; ++j) {
+            DrawData data = draw_data(instance++, frame);
+
+            scene.shader.set_uniform_2f(scene.u_offset, data.x, data.y);
+            scene.shader.set_uniform_4f(scene.u_color, data.r, data.g, data.b, data.a);
+            scene.meshes[i].draw_elements(scene.index_counts[i]);
+        }
+    }
+}
+
+static void draw_indirect(IndirectScene& scene, std::size_t frame)
+{
+    gl(Clear, GL_COLOR_BUFFER_BIT);
+
+    std::size_t count = scene.commands.get_instance_count();
+    DrawData* data = frame_arena().allocate_array<DrawData>(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        data[i] = draw_data(i, frame);
+    }
+
+    scene.per_draw->bind();
+    scene.per_draw->set_data(data, count * sizeof(DrawData));
+
+    scene.shader.bind();
+    scene.va.bind();
+    scene.commands.bind();
+    scene.commands.draw(scene.va);
+}
+
+template <typename Draw>
+static double run(std::size_t frames, Draw draw, double& cpu_time)
+{
+    cpu_time = 0;
+
+    double start = bench_now();
+
+    for (std::size_t frame = 0; frame < frames; ++frame) {
+        double frame_start = bench_now();
+        draw(frame);
+        cpu_time += bench_now() - frame_start;
+
+        gl_frame_check_errors();
+        bench_swap_buffers();
+    }
+
+    glFinish();
+
+    return bench_now() - start;
+}
+
+static std::vector<unsigned char> read_pixels()
+{
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    std::vector<unsigned char> pixels((std::size_t)viewport[2] * viewport[3] * 4);
+    gl(ReadPixels, viewport[0], viewport[1], viewport[2], viewport[3],
+                   GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+    return pixels;
+}
+
+// Draws the first frame both ways.
+static bool check_same_image(const char* label, DirectScene& direct, IndirectScene& indirect)
+{
+    draw_direct(direct, 0);
+    std::vector<unsigned char> direct_pixels = read_pixels();
+    draw_indirect(indirect, 0);
+    std::vector<unsigned char> indirect_pixels = read_pixels();
+
+    if (std::count(direct_pixels.begin(), direct_pixels.end(), 0) == (long)direct_pixels.size()) {
+        std::cerr << "ERROR: " << label << ": nothing was drawn" << std::endl;
+        return false;
+    }
+
+    if (direct_pixels != indirect_pixels) {
+        std::cerr << "ERROR: " << label << ": indirect draws don't match direct ones"
+                  << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    Context context(bench_context_settings(argc, argv));
+    if (!bench_init_context(context))
+        return 1;
+
+    std::size_t frames = argc > 1 ? std::atol(argv[1]) : 50;
+    std::size_t mesh_count = argc > 2 ? std::atol(argv[2]) : 10000;
+
+    gl_init_errors();
+
+    if (!multi_draw_indirect_supported()) {
+        std::cerr << "ERROR: glMultiDrawElementsIndirect is not supported" << std::endl;
+        return 1;
+    }
+
+    Shader direct_shader("resources/offset_color.glsl");
+    Shader indirect_shader("resources/instanced_color.glsl");
+    if (!direct_shader.valid || !indirect_shader.valid)
+        return 1;
+
+    direct_shader.bind();
+    direct_shader.set_uniform_1f("u_Scale", 1.0f);
+    indirect_shader.bind();
+    indirect_shader.set_uniform_1f("u_Scale", 1.0f);
+
+    DirectScene direct = {
+        direct_shader,
+        direct_shader.get_uniform("u_Offset"), direct_shader.get_uniform("u_Color"),
+        {}, {}, {},
+    };
+    direct.meshes.reserve(mesh_count);
+
+    MeshData pool;
+    DrawIndirectBuffer commands;
+    // Every fourth mesh three times.
+    DrawIndirectBuffer instanced_commands;
+    std::vector<std::size_t> instances;
+    std::size_t triangles = 0;
+
+    for (std::uint32_t i = 0; i < mesh_count; ++i) {
+        MeshData mesh;
+        make_polygon(i, mesh);
+
+        VertexArray& va = direct.meshes.emplace_back();
+        va.bind();
+        mesh.upload(&va);
+        va.unbind_all();
+        direct.index_counts.push_back(mesh.indices.size());
+
+        MeshRange range;
+        if (!append_mesh(pool, mesh, range))
+            return 1;
+
+        commands.add(range);
+
+        instances.push_back(i % 4 == 0 ? 3 : 1);
+        instanced_commands.add(range, instances.back());
+
+        triangles += mesh.indices.size() / 3;
+    }
+
+    commands.upload();
+    instanced_commands.upload();
+
+    VertexArray pool_va;
+    pool_va.bind();
+    pool.upload(&pool_va);
+
+    VertexBuffer* per_draw = pool_va.bind_vertex_buffer(nullptr, mesh_count * sizeof(DrawData),
+                                                        GL_STREAM_DRAW);
+    per_draw->set_layout<DrawDataLayout>(1, 1);
+    pool_va.unbind_all();
+
+    IndirectScene indirect = { indirect_shader, pool_va, per_draw, commands };
+
+    std::cout << "meshes: " << mesh_count << ", triangles: " << triangles << std::endl;
+
+    // Same frame both ways, before timing anything.
+    if (!check_same_image("one instance per draw", direct, indirect))
+        return 1;
+
+    direct.instances = instances;
+    IndirectScene instanced = { indirect_shader, pool_va, per_draw, instanced_commands };
+
+    if (!check_same_image("several instances per draw", direct, instanced))
+        return 1;
+
+    direct.instances.clear();
+
+    // The first frames are slower whatever draws them.
+    double cpu_time;
+    run(frames / 10 + 1, [&](std::size_t frame) { draw_direct(direct, frame); }, cpu_time);
+    run(frames / 10 + 1, [&](std::size_t frame) { draw_indirect(indirect, frame); }, cpu_time);
+
+    double direct_cpu, indirect_cpu;
+    double direct_time = run(frames, [&](std::size_t frame) {
+        draw_direct(direct, frame);
+    }, direct_cpu);
+    double indirect_time = run(frames, [&](std::size_t frame) {
+        draw_indirect(indirect, frame);
+    }, indirect_cpu);
+
+    std::cout << "direct (" << mesh_count << " draws/frame):" << std::endl;
+    std::cout << "  ms/frame:     " << direct_time * 1000.0 / frames << std::endl;
+    std::cout << "  submit ms:    " << direct_cpu * 1000.0 / frames << std::endl;
+    std::cout << "indirect (1 draw/frame):" << std::endl;
+    std::cout << "  ms/frame:     " << indirect_time * 1000.0 / frames << std::endl;
+    std::cout << "  submit ms:    " << indirect_cpu * 1000.0 / frames << std::endl;
+
+    return 0;
+}
\ No newline at end of file
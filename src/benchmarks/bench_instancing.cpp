@@ -0,0 +1,164 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+#include "bench_common.hpp"
+
+#include "../advanced/opengl/errors.hpp"
+#include "../advanced/opengl/vertex_array.hpp"
+#include "../advanced/opengl/shader.hpp"
+
+// Draws the triangle from abstraction_sample.cpp many times with:
+//  - instanced: one `draw_elements_instanced`, offsets and colors
+//               come from per-instance attributes;
+//  - loop:      one `draw_elements` per triangle, offsets and colors
+//               set with uniforms.
+
+const float TRIANGLE_SCALE = 0.002f;
+
+struct Instance {
+    float x, y;
+    float r, g, b, a;
+};
+
+using InstanceLayout = VertexLayout<Attr<float, 2>, Attr<float, 4>>;
+VERTEX_LAYOUT_CHECK(InstanceLayout, Instance, x, r);
+
+static float vertexes[] = {
+    // x    y
+    -0.5f, -0.5f,
+    +0.0f, +0.5f,
+    +0.5f, -0.5f,
+};
+
+static unsigned int indices[] = {
+    0, 1, 2
+};
+
+static Instance make_instance(std::size_t i)
+{
+    float x = (float)(i % 1000) / 500.0f - 1.0f;
+    float y = (float)(i / 1000 % 1000) / 500.0f - 1.0f;
+
+    return { x, y, (float)(i % 7) / 7.0f, 0.3f, 0.8f, 1.0f };
+}
+
+static void report(const char* label, std::size_t frames, std::size_t instance_count,
+                   double elapsed)
+{
+    std::cout << label << ":" << std::endl;
+    std::cout << "  instances:  " << instance_count << std::endl;
+    std::cout << "  ms/frame:   " << elapsed * 1000.0 / frames << std::endl;
+    std::cout << "  ns/object:  " << elapsed * 1e9 / (frames * instance_count) << std::endl;
+}
+
+static void run_instanced(std::size_t frames, std::size_t instance_count)
+{
+    std::vector<Instance> instances(instance_count);
+    for (std::size_t i = 0; i < instance_count; ++i) {
+        instances[i] = make_instance(i);
+    }
+
+    VertexArray va;
+    va.bind();
+
+    VertexBuffer* vb = va.bind_vertex_buffer(vertexes, sizeof(vertexes));
+    vb->set_attribute_layout(0, 2, GL_FLOAT, GL_FALSE, sizeof(vertexes[0]) * 2, 0);
+
+    VertexBuffer* instance_vb = va.bind_vertex_buffer(instances.data(), 
+                                                       instances.size() * sizeof(Instance));
+    instance_vb->set_layout<InstanceLayout>(1, 1);
+
+    va.bind_index_buffer(indices, 3);
+
+    va.unbind_all();
+
+    Shader shader("resources/instanced_color.glsl");
+    shader.bind();
+    shader.set_uniform_1f("u_Scale", TRIANGLE_SCALE);
+    shader.unbind();
+
+    double start = bench_now();
+
+    for (std::size_t frame = 0; frame < frames; ++frame) {
+        gl(Clear, GL_COLOR_BUFFER_BIT);
+
+        shader.bind();
+        va.bind();
+        va.draw_elements_instanced(3, instance_count);
+        va.unbind();
+        shader.unbind();
+
+        gl_frame_check_errors();
+        bench_swap_buffers();
+    }
+
+    glFinish();
+
+    report("instanced", frames, instance_count, bench_now() - start);
+}
+
+static void run_loop(std::size_t frames, std::size_t instance_count)
+{
+    VertexArray va;
+    va.bind();
+
+    VertexBuffer* vb = va.bind_vertex_buffer(vertexes, sizeof(vertexes));
+    vb->set_attribute_layout(0, 2, GL_FLOAT, GL_FALSE, sizeof(vertexes[0]) * 2, 0);
+
+    va.bind_index_buffer(indices, 3);
+
+    va.unbind_all();
+
+    Shader shader("resources/offset_color.glsl");
+    UniformHandle u_offset = shader.get_uniform("u_Offset");
+    UniformHandle u_color = shader.get_uniform("u_Color");
+
+    shader.bind();
+    shader.set_uniform_1f("u_Scale", TRIANGLE_SCALE);
+    shader.unbind();
+
+    double start = bench_now();
+
+    for (std::size_t frame = 0; frame < frames; ++frame) {
+        gl(Clear, GL_COLOR_BUFFER_BIT);
+
+        shader.bind();
+        va.bind();
+
+        for (std::size_t i = 0; i < instance_count; ++i) {
+            Instance instance = make_instance(i);
+
+            shader.set_uniform_2f(u_offset, instance.x, instance.y);
+            shader.set_uniform_4f(u_color, instance.r, instance.g, instance.b, instance.a);
+            va.draw_elements(3);
+        }
+
+        va.unbind();
+        shader.unbind();
+
+        gl_frame_check_errors();
+        bench_swap_buffers();
+    }
+
+    glFinish();
+
+    report("loop", frames, instance_count, bench_now() - start);
+}
+
+int main(int argc, char** argv)
+{
+    Context context(bench_context_settings(argc, argv));
+    if (!bench_init_context(context))
+        return 1;
+
+    std::size_t frames = argc > 1 ? std::atol(argv[1]) : 10;
+    std::size_t instance_count = argc > 2 ? std::atol(argv[2]) : 1000000;
+
+    gl_init_errors();
+
+    run_instanced(frames, instance_count);
+    run_loop(frames, instance_count);
+
+    return 0;
+}
\ No newline at end of file
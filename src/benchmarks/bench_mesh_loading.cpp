@@ -0,0 +1,243 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+#include "bench_common.hpp"
+
+#include "../advanced/opengl/errors.hpp"
+#include "../advanced/opengl/vertex_array.hpp"
+#include "../advanced/opengl/mesh.hpp"
+#include "../advanced/opengl/shader.hpp"
+
+// Loads the same mesh (a grid with texture coordinates and normals,
+// 1M triangles by default) from an OBJ file and from a `.mesh` file,
+// up to the point where it's on the GPU. The files are written next
+// to the given path prefix, and are read from the page cache: this
+// measures parsing, not the disk. OBJ parsing is also timed with 1, 2,
+// 4... threads up to the number of cores (or the 4th argument).
+
+static bool write_grid_obj(const std::string& path, std::size_t side)
+{
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "ERROR: could not create `" << path << "`" << std::endl;
+        return false;
+    }
+
+    for (std::size_t y = 0; y < side; ++y) {
+        for (std::size_t x = 0; x < side; ++x) {
+            float u = (float)x / (side - 1);
+            float v = (float)y / (side - 1);
+            std::fprintf(file, "v %f %f %f\nvt %f %f\nvn 0 0 1\n",
+                         u * 1.8f - 0.9f, v * 1.8f - 0.9f, 0.0f, u, v);
+        }
+    }
+
+    for (std::size_t y = 0; y + 1 < side; ++y) {
+        for (std::size_t x = 0; x + 1 < side; ++x) {
+            std::size_t a = y * side + x + 1;
+            std::size_t b = a + 1;
+            std::size_t c = b + side;
+            std::size_t d = a + side;
+            std::fprintf(file, "f %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu\n",
+                         a, a, a, b, b, b, c, c, c, d, d, d);
+        }
+    }
+
+    return std::fclose(file) == 0;
+}
+
+// Writes `path` back with its header changed by each of `corruptions`
+// and checks `MeshFile` rejects it. The sizes picked make the products
+// and sums of an unchecked header wrap around to something small.
+static bool check_corrupt_headers(const std::string& path)
+{
+    std::vector<char> bytes;
+    {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file)
+            return false;
+
+        std::fseek(file, 0, SEEK_END);
+        bytes.resize(std::ftell(file));
+        std::fseek(file, 0, SEEK_SET);
+        bool read = std::fread(bytes.data(), 1, bytes.size(), file) == bytes.size();
+        std::fclose(file);
+
+        if (!read)
+            return false;
+    }
+
+    using Corruption = std::function<void(MeshFileHeader&, MeshFileAttribute*)>;
+    const std::pair<const char*, Corruption> corruptions[] = {
+        { "a wrapping vertex count", [](MeshFileHeader& header, MeshFileAttribute*) {
+            header.vertex_count = (~0ull / header.stride) + 1;
+        } },
+        { "a wrapping index count", [](MeshFileHeader& header, MeshFileAttribute*) {
+            header.index_count = 1ull << 62;
+        } },
+        { "a wrapping vertex offset", [](MeshFileHeader& header, MeshFileAttribute*) {
+            header.vertex_offset = ~0ull;
+        } },
+        { "a zero stride", [](MeshFileHeader& header, MeshFileAttribute*) {
+            header.stride = 0;
+        } },
+        { "an attribute of 5 components", [](MeshFileHeader&, MeshFileAttribute* attributes) {
+            attributes[0].count = 5;
+        } },
+        { "indices over the vertices", [](MeshFileHeader& header, MeshFileAttribute*) {
+            header.index_offset = header.vertex_offset;
+        } },
+    };
+
+    std::string corrupt_path = path + ".corrupt";
+    bool ok = true;
+
+    for (const auto& [name, corrupt] : corruptions) {
+        std::vector<char> corrupt_bytes = bytes;
+        MeshFileHeader header;
+        std::memcpy(&header, corrupt_bytes.data(), sizeof(header));
+        corrupt(header, (MeshFileAttribute*)(corrupt_bytes.data() + sizeof(header)));
+        std::memcpy(corrupt_bytes.data(), &header, sizeof(header));
+
+        std::FILE* file = std::fopen(corrupt_path.c_str(), "wb");
+        if (!file)
+            return false;
+        std::fwrite(corrupt_bytes.data(), 1, corrupt_bytes.size(), file);
+        std::fclose(file);
+
+        if (MeshFile(corrupt_path).valid) {
+            std::cerr << "ERROR: a mesh file with " << name << " was accepted" << std::endl;
+            ok = false;
+        }
+    }
+
+    std::remove(corrupt_path.c_str());
+
+    return ok;
+}
+
+static void draw(VertexArray& va, std::size_t index_count)
+{
+    gl(Clear, GL_COLOR_BUFFER_BIT);
+    va.draw_elements(index_count);
+
+    gl_frame_check_errors();
+    bench_swap_buffers();
+}
+
+int main(int argc, char** argv)
+{
+    Context context(bench_context_settings(argc, argv));
+    if (!bench_init_context(context))
+        return 1;
+
+    std::size_t runs = argc > 1 ? std::atol(argv[1]) : 3;
+    std::size_t side = argc > 2 ? std::atol(argv[2]) : 710;
+    std::string prefix = argc > 3 ? argv[3] : "build/bench_mesh";
+    unsigned int max_threads = argc > 4 ? std::atol(argv[4])
+                                        : std::max(1u, std::thread::hardware_concurrency());
+
+    gl_init_errors();
+
+    std::string obj_path = prefix + ".obj";
+    std::string mesh_path = prefix + ".mesh";
+
+    if (!write_grid_obj(obj_path, side))
+        return 1;
+
+    {
+        MeshData mesh;
+        if (!load_obj(obj_path, mesh) || !save_mesh(mesh_path, mesh))
+            return 1;
+
+        std::cout << "INFO: " << mesh.indices.size() / 3 << " triangles, "
+                  << mesh.vertex_count << " vertices" << std::endl;
+    }
+
+    if (!check_corrupt_headers(mesh_path))
+        return 1;
+
+    Shader shader("resources/default_fragment_color.glsl");
+    shader.bind();
+    shader.set_uniform_4f("u_Color", 0.2f, 0.6f, 0.9f, 1.0f);
+
+    double obj_parse = 1e9, obj_total = 1e9;
+    double mesh_map = 1e9, mesh_total = 1e9;
+
+    for (std::size_t run = 0; run < runs; ++run) {
+        double start = bench_now();
+
+        MeshData mesh;
+        load_obj(obj_path, mesh);
+        double parsed = bench_now();
+
+        VertexArray va;
+        va.bind();
+        mesh.upload(&va);
+        glFinish();
+        double uploaded = bench_now();
+
+        draw(va, mesh.indices.size());
+
+        obj_parse = std::min(obj_parse, parsed - start);
+        obj_total = std::min(obj_total, uploaded - start);
+    }
+
+    for (std::size_t run = 0; run < runs; ++run) {
+        double start = bench_now();
+
+        MeshFile file(mesh_path);
+        if (!file.valid)
+            return 1;
+        double mapped = bench_now();
+
+        VertexArray va;
+        va.bind();
+        file.upload(&va);
+        glFinish();
+        double uploaded = bench_now();
+
+        draw(va, file.get_index_count());
+
+        mesh_map = std::min(mesh_map, mapped - start);
+        mesh_total = std::min(mesh_total, uploaded - start);
+    }
+
+    std::vector<double> thread_parse;
+    for (unsigned int threads = 1; threads <= max_threads; threads *= 2) {
+        double best = 1e9;
+
+        for (std::size_t run = 0; run < runs; ++run) {
+            double start = bench_now();
+
+            MeshData mesh;
+            load_obj(obj_path, mesh, threads);
+
+            best = std::min(best, bench_now() - start);
+        }
+
+        thread_parse.push_back(best);
+    }
+
+    std::cout << "obj (best of " << runs << "):" << std::endl;
+    std::cout << "  parse ms:      " << obj_parse * 1000.0 << std::endl;
+    for (std::size_t i = 0; i < thread_parse.size(); ++i) {
+        std::cout << "  " << (1 << i) << " thread(s):   " << thread_parse[i] * 1000.0
+                  << " ms (" << thread_parse[0] / thread_parse[i] << "x)" << std::endl;
+    }
+    std::cout << "  to GPU ms:     " << obj_total * 1000.0 << std::endl;
+    std::cout << "mesh (best of " << runs << "):" << std::endl;
+    std::cout << "  map ms:        " << mesh_map * 1000.0 << std::endl;
+    std::cout << "  to GPU ms:     " << mesh_total * 1000.0 << std::endl;
+
+    shader.unbind();
+
+    return 0;
+}
\ No newline at end of file
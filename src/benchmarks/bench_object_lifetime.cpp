@@ -0,0 +1,132 @@
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <cstdlib>
+
+#include "bench_common.hpp"
+
+#include "../advanced/opengl/errors.hpp"
+#include "../advanced/opengl/vertex_array.hpp"
+#include "../advanced/opengl/shader.hpp"
+
+// Creates and destroys meshes (a vertex array with its buffers) every
+// frame, like a long running process streaming a world in and out,
+// moving them around on the way. Fails if any GL name outlives its
+// wrapper, by the counts of `gl_live_names` and by asking the driver.
+// Build with `-DGL_COUNTERS=1` (the default) for the counts.
+
+static VertexArray make_mesh(std::size_t i)
+{
+    float x = (float)(i % 100) / 50.0f - 1.0f;
+    float y = (float)(i / 100 % 100) / 50.0f - 1.0f;
+
+    float vertexes[] = {
+        x, y,
+        x + 0.01f, y,
+        x + 0.01f, y + 0.01f,
+        x, y + 0.01f,
+    };
+
+    unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+
+    VertexArray va;
+    va.bind();
+
+    VertexBuffer* vb = va.bind_vertex_buffer(vertexes, sizeof(vertexes));
+    vb->set_layout<VertexLayout<Attr<float, 2>>>();
+    va.bind_index_buffer(indices, 6);
+
+    va.unbind_all();
+
+    // Moved out (or elided), the names go with it.
+    return va;
+}
+
+int main(int argc, char** argv)
+{
+    Context context(bench_context_settings(argc, argv));
+    if (!bench_init_context(context))
+        return 1;
+
+    std::size_t frames = argc > 1 ? std::atol(argv[1]) : 100;
+    std::size_t meshes_per_frame = argc > 2 ? std::atol(argv[2]) : 1000;
+
+    gl_init_errors();
+
+    GLLiveNames before = gl_live_names();
+
+    Shader shader("resources/default_fragment_color.glsl");
+    if (!shader.valid)
+        return 1;
+
+    std::vector<GLuint> last_vertex_arrays;
+
+    double start = bench_now();
+
+    for (std::size_t frame = 0; frame < frames; ++frame) {
+        std::vector<VertexArray> meshes;
+        for (std::size_t i = 0; i < meshes_per_frame; ++i) {
+            meshes.push_back(make_mesh(frame * meshes_per_frame + i));
+        }
+
+        // Move assignment deletes what the target had.
+        std::swap(meshes.front(), meshes.back());
+        meshes.front() = make_mesh(frame);
+
+        gl(Clear, GL_COLOR_BUFFER_BIT);
+        shader.bind();
+
+        for (VertexArray& va : meshes) {
+            va.bind();
+            va.draw_elements(6);
+        }
+
+        if (frame + 1 == frames) {
+            for (VertexArray& va : meshes) {
+                last_vertex_arrays.push_back(va.get_id());
+            }
+        }
+
+        gl_frame_check_errors();
+        bench_swap_buffers();
+    }
+
+    glFinish();
+
+    double elapsed = bench_now() - start;
+
+    shader.unbind();
+
+    std::cout << "create+draw+destroy:" << std::endl;
+    std::cout << "  meshes/s:      " << frames * meshes_per_frame / elapsed << std::endl;
+    std::cout << "  ms/frame:      " << elapsed * 1000.0 / frames << std::endl;
+
+    std::size_t still_names = 0;
+    for (GLuint name : last_vertex_arrays) {
+        if (glIsVertexArray(name))
+            still_names++;
+    }
+
+    GLLiveNames after = gl_live_names();
+    std::ptrdiff_t leaked_buffers = after.buffers - before.buffers;
+    std::ptrdiff_t leaked_vertex_arrays = after.vertex_arrays - before.vertex_arrays;
+    // Only the shader is still alive.
+    std::ptrdiff_t leaked_programs = after.programs - before.programs - 1;
+
+    std::cout << "  leaked:        " << leaked_buffers << " buffers, "
+              << leaked_vertex_arrays << " vertex arrays, "
+              << leaked_programs << " programs (counted), "
+              << still_names << " vertex arrays (driver)" << std::endl;
+
+    bool leaked = still_names != 0;
+#if GL_COUNTERS
+    leaked = leaked || leaked_buffers != 0 || leaked_vertex_arrays != 0 || leaked_programs != 0;
+#endif
+
+    if (leaked) {
+        std::cerr << "ERROR: GL names leaked" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
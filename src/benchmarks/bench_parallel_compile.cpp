@@ -0,0 +1,131 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+#include "bench_common.hpp"
+
+#include "../advanced/opengl/errors.hpp"
+#include "../advanced/opengl/shader.hpp"
+#include "../advanced/opengl/shader_library.hpp"
+
+// Compiles many synthetic programs:
+//  - sequential: one blocking `Shader` after the other;
+//  - library:    everything submitted up front through `ShaderLibrary`,
+//                then polled until done.
+
+static std::string synthetic_shader(std::size_t index)
+{
+    std::string source;
+
+    source.append("#shader vertex\n");
+    source.append("#version 330 core\n");
+    source.append("layout(location = 0) in vec4 position;\n");
+    source.append("void main()\n{\n");
+    source.append("    gl_Position = position * " + std::to_string(index + 1) + ".0;\n");
+    source.append("}\n\n");
+
+    source.append("#shader fragment\n");
+    source.append("#version 330 core\n");
+    source.append("layout(location = 0) out vec4 color;\n");
+    source.append("uniform vec4 u_Color;\n");
+
+    // Enough functions to make the compiler work a bit.
+    for (std::size_t i = 0; i < 16; ++i) {
+        std::string name = "f" + std::to_string(i);
+        std::string previous = i == 0 ? "v" : "f" + std::to_string(i - 1) + "(v)";
+
+        source.append("vec4 " + name + "(vec4 v)\n{\n");
+        source.append("    vec4 r = " + previous + ";\n");
+        source.append("    for (int k = 0; k < " + std::to_string(index % 5 + 2) + "; ++k)\n");
+        source.append("        r = sin(r * " + std::to_string(i + index) + ".0 + v) * 0.5;\n");
+        source.append("    return r;\n}\n");
+    }
+
+    source.append("void main()\n{\n");
+    source.append("    color = f15(u_Color);\n");
+    source.append("}\n");
+
+    return source;
+}
+
+static void report(const char* label, std::size_t count, double elapsed)
+{
+    std::cout << label << ":" << std::endl;
+    std::cout << "  total:       " << elapsed * 1000.0 << " ms" << std::endl;
+    std::cout << "  per program: " << elapsed * 1000.0 / count << " ms" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    Context context(bench_context_settings(argc, argv));
+    if (!bench_init_context(context))
+        return 1;
+
+    std::size_t count = argc > 1 ? std::atol(argv[1]) : 64;
+    std::string directory = argc > 2 ? argv[2] : "build/synthetic_shaders";
+
+    gl_init_errors();
+
+    std::filesystem::create_directories(directory);
+
+    std::vector<std::string> paths;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::string path = directory + "/program_" + std::to_string(i) + ".glsl";
+
+        std::ofstream stream(path);
+        stream << synthetic_shader(i);
+
+        paths.push_back(path);
+    }
+
+    // New sources for every run, so Mesa's own shader cache
+    // doesn't turn the compilations into lookups.
+    std::string salt = std::to_string((long long)(bench_now() * 1e6));
+
+    {
+        std::vector<Shader> shaders;
+        shaders.reserve(paths.size());
+
+        double start = bench_now();
+
+        for (const auto& path : paths) {
+            shaders.emplace_back(path, std::vector<std::string> { "SALT " + salt + "0" });
+        }
+
+        glFinish();
+        report("sequential", count, bench_now() - start);
+    }
+
+    {
+        ShaderLibrary library;
+        std::cout << "INFO: parallel compilation: " 
+                  << (library.is_parallel() ? "yes" : "no") << std::endl;
+
+        double start = bench_now();
+
+        for (std::size_t i = 0; i < count; ++i) {
+            library.add(std::to_string(i), paths[i], { "SALT " + salt + "1" });
+        }
+
+        double submitted = bench_now();
+
+        // This is where a real application would keep rendering
+        // a loading screen.
+        std::size_t polls = 0;
+        while (library.poll() > 0) {
+            polls++;
+        }
+
+        glFinish();
+
+        double elapsed = bench_now() - start;
+        report("library", count, elapsed);
+        std::cout << "  submission:  " << (submitted - start) * 1000.0 << " ms" << std::endl;
+        std::cout << "  polls:       " << polls << std::endl;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,220 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+#include "bench_common.hpp"
+
+#include "../advanced/opengl/errors.hpp"
+#include "../advanced/opengl/vertex_array.hpp"
+#include "../advanced/opengl/shader.hpp"
+#include "../advanced/opengl/command_buffer.hpp"
+#include "../advanced/opengl/render_thread.hpp"
+
+// Simulates many objects and draws each of them (a uniform update and
+// a draw call per object) every frame:
+//  - direct:      simulation and GL calls on one thread, like the samples;
+//  - one thread:  same, but recorded into a `CommandBuffer` first;
+//  - two threads: recorded on the main thread, executed on a `RenderThread`
+//                 while the main thread simulates the next frame.
+// Two threads can at best hide the cheaper of simulation and submission,
+// and only with a core to spare for each (llvmpipe also rasterizes on
+// its own threads).
+
+struct Object {
+    float x, y;
+    float vx, vy;
+};
+
+// Stands for game logic: a few steps of a small integration per object.
+static void simulate(std::vector<Object>& objects, std::size_t work)
+{
+    for (Object& object : objects) {
+        for (std::size_t step = 0; step < work; ++step) {
+            float angle = std::atan2(object.vy, object.vx) + 0.001f;
+            float speed = std::sqrt(object.vx * object.vx + object.vy * object.vy);
+
+            object.vx = std::cos(angle) * speed;
+            object.vy = std::sin(angle) * speed;
+        }
+
+        object.x += object.vx;
+        object.y += object.vy;
+
+        if (object.x < -1.0f || object.x > 1.0f)
+            object.vx = -object.vx;
+        if (object.y < -1.0f || object.y > 1.0f)
+            object.vy = -object.vy;
+    }
+}
+
+static std::vector<Object> make_objects(std::size_t count)
+{
+    std::vector<Object> objects(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        float t = (float)i / count;
+        objects[i] = { t * 2.0f - 1.0f, std::sin(t * 37.0f), 0.003f * std::cos(t * 11.0f),
+                       0.002f * std::sin(t * 13.0f) };
+    }
+
+    return objects;
+}
+
+struct Scene {
+    VertexArray& va;
+    Shader& shader;
+    UniformHandle u_offset;
+    UniformHandle u_color;
+};
+
+static void record(CommandBuffer& frame, Scene& scene, const std::vector<Object>& objects)
+{
+    frame.clear(GL_COLOR_BUFFER_BIT);
+    frame.bind_shader(scene.shader);
+    frame.bind_vertex_array(scene.va);
+
+    for (std::size_t i = 0; i < objects.size(); ++i) {
+        frame.set_uniform_2f(scene.shader, scene.u_offset, objects[i].x, objects[i].y);
+        frame.set_uniform_4f(scene.shader, scene.u_color, (float)(i % 7) / 7.0f, 0.3f, 0.8f, 1.0f);
+        frame.draw_elements(scene.va, 6);
+    }
+}
+
+static void report(const char* label, std::size_t frames, double elapsed)
+{
+    std::cout << label << ":" << std::endl;
+    std::cout << "  ms/frame: " << elapsed * 1000.0 / frames << std::endl;
+}
+
+static double run_direct(std::size_t frames, Scene& scene, std::size_t object_count,
+                         std::size_t work)
+{
+    std::vector<Object> objects = make_objects(object_count);
+    double start = bench_now();
+
+    for (std::size_t f = 0; f < frames; ++f) {
+        simulate(objects, work);
+
+        gl(Clear, GL_COLOR_BUFFER_BIT);
+        scene.shader.bind();
+        scene.va.bind();
+
+        for (std::size_t i = 0; i < objects.size(); ++i) {
+            scene.shader.set_uniform_2f(scene.u_offset, objects[i].x, objects[i].y);
+            scene.shader.set_uniform_4f(scene.u_color, (float)(i % 7) / 7.0f, 0.3f, 0.8f, 1.0f);
+            scene.va.draw_elements(6);
+        }
+
+        gl_frame_check_errors();
+        bench_swap_buffers();
+    }
+
+    glFinish();
+
+    return bench_now() - start;
+}
+
+static double run_one_thread(std::size_t frames, Scene& scene, std::size_t object_count,
+                             std::size_t work)
+{
+    std::vector<Object> objects = make_objects(object_count);
+    CommandBuffer frame;
+    double start = bench_now();
+
+    for (std::size_t f = 0; f < frames; ++f) {
+        simulate(objects, work);
+        record(frame, scene, objects);
+
+        frame.execute();
+        frame.reset();
+
+        gl_frame_check_errors();
+        bench_swap_buffers();
+    }
+
+    glFinish();
+
+    return bench_now() - start;
+}
+
+static double run_two_threads(std::size_t frames, Scene& scene, std::size_t object_count,
+                              std::size_t work)
+{
+    std::vector<Object> objects = make_objects(object_count);
+    double start = bench_now();
+
+    RenderThread render_thread(*bench_context);
+    if (!render_thread.valid)
+        return 0;
+
+    for (std::size_t f = 0; f < frames; ++f) {
+        // Simulating doesn't need a buffer, only
+        // recording may wait for the render thread.
+        simulate(objects, work);
+
+        CommandBuffer& frame = render_thread.begin_frame();
+        record(frame, scene, objects);
+
+        render_thread.end_frame();
+    }
+
+    render_thread.stop();
+
+    glFinish();
+
+    return bench_now() - start;
+}
+
+int main(int argc, char** argv)
+{
+    Context context(bench_context_settings(argc, argv));
+    if (!bench_init_context(context))
+        return 1;
+
+    std::size_t frames = argc > 1 ? std::atol(argv[1]) : 300;
+    std::size_t object_count = argc > 2 ? std::atol(argv[2]) : 2000;
+    std::size_t work = argc > 3 ? std::atol(argv[3]) : 20;
+
+    gl_init_errors();
+
+    float size = 0.01f;
+    float vertexes[] = {
+        -size, -size,
+        +size, -size,
+        +size, +size,
+        -size, +size,
+    };
+
+    unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+
+    VertexArray va;
+    va.bind();
+
+    VertexBuffer* vb = va.bind_vertex_buffer(vertexes, sizeof(vertexes));
+    vb->set_layout<VertexLayout<Attr<float, 2>>>();
+    va.bind_index_buffer(indices, 6);
+
+    va.unbind_all();
+
+    Shader shader("resources/offset_color.glsl");
+    if (!shader.valid)
+        return 1;
+
+    shader.bind();
+    shader.set_uniform_1f("u_Scale", 1.0f);
+
+    Scene scene = { va, shader, shader.get_uniform("u_Offset"), shader.get_uniform("u_Color") };
+
+    std::cout << "objects: " << object_count << ", simulation steps: " << work << std::endl;
+
+    // The first frames are slower whatever draws them (llvmpipe
+    // compiles the draw code on first use), keep them out of the runs.
+    run_direct(frames / 10 + 1, scene, object_count, work);
+
+    report("direct", frames, run_direct(frames, scene, object_count, work));
+    report("one thread", frames, run_one_thread(frames, scene, object_count, work));
+    report("two threads", frames, run_two_threads(frames, scene, object_count, work));
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <cstdlib>
+
+#include <GL/glew.h>
+
+#include "bench_common.hpp"
+
+#include "../advanced/opengl/shader_source.hpp"
+
+// Parses a generated multi-megabyte `#shader` file with:
+//  - legacy: the `getline` loop `Shader::Shader` used to have;
+//  - cold:   `ShaderSourceLoader` reading the file every time;
+//  - warm:   `ShaderSourceLoader` with the file already cached.
+// Doesn't need an OpenGL context.
+
+struct LegacySources {
+    std::string vertex;
+    std::string fragment;
+};
+
+static LegacySources legacy_parse(const std::string& file_path)
+{
+    std::ifstream stream(file_path);
+
+    std::string vertex_source;
+    std::string fragment_source;
+    GLenum shader_mode = GL_VERTEX_SHADER;
+
+    std::string line;
+    while (getline(stream, line)) {
+        if (line.find("#shader") != std::string::npos) {
+            if (line.find("vertex") != std::string::npos)
+                shader_mode = GL_VERTEX_SHADER;
+            else if (line.find("fragment") != std::string::npos)
+                shader_mode = GL_FRAGMENT_SHADER;
+
+            continue;
+        }
+
+        if (shader_mode == GL_VERTEX_SHADER) {
+            vertex_source.append(line);
+            vertex_source.append("\n");
+        } else if (shader_mode == GL_FRAGMENT_SHADER) {
+            fragment_source.append(line);
+            fragment_source.append("\n");
+        }
+    }
+
+    return { vertex_source, fragment_source };
+}
+
+static void generate(const std::string& path, std::size_t megabytes)
+{
+    std::ofstream stream(path);
+    std::size_t half = megabytes * 1024 * 1024 / 2;
+
+    for (const char* stage : { "vertex", "fragment" }) {
+        stream << "#shader " << stage << "\n";
+        stream << "#version 330 core\n";
+
+        std::size_t written = 0;
+        for (std::size_t i = 0; written < half; ++i) {
+            std::string line = "    float v" + std::to_string(i) + 
+                               " = sin(float(" + std::to_string(i) + ") * 0.5); // filler\n";
+            stream << line;
+            written += line.size();
+        }
+
+        stream << "void main() {}\n\n";
+    }
+}
+
+template <typename F>
+static void run(const char* label, std::size_t iterations, std::size_t bytes, F&& parse)
+{
+    double start = bench_now();
+
+    std::size_t parsed = 0;
+    for (std::size_t i = 0; i < iterations; ++i) {
+        parsed += parse();
+    }
+
+    double elapsed = bench_now() - start;
+
+    if (parsed != bytes * iterations) {
+        std::cerr << "ERROR: " << label << " parsed " << parsed / iterations
+                  << " bytes, expected " << bytes << std::endl;
+    }
+
+    std::cout << label << ":" << std::endl;
+    std::cout << "  ms/parse:  " << elapsed * 1000.0 / iterations << std::endl;
+    std::cout << "  MB/second: " << (double)(bytes * iterations) / (1024.0 * 1024.0) / elapsed 
+              << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t megabytes = argc > 1 ? std::atol(argv[1]) : 16;
+    std::size_t iterations = argc > 2 ? std::atol(argv[2]) : 10;
+    std::string path = argc > 3 ? argv[3] : "build/bench_shader_parse.glsl";
+
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+    generate(path, megabytes);
+
+    // Stage contents, without the `#shader` lines.
+    LegacySources reference = legacy_parse(path);
+    std::size_t bytes = reference.vertex.size() + reference.fragment.size();
+
+    std::cout << "INFO: " << bytes / (1024 * 1024) << " MB of shader source" << std::endl;
+
+    run("legacy", iterations, bytes, [&]() {
+        LegacySources sources = legacy_parse(path);
+        return sources.vertex.size() + sources.fragment.size();
+    });
+
+    ShaderSourceLoader loader;
+    ShaderSources sources;
+
+    run("cold", iterations, bytes, [&]() {
+        loader.clear_cache();
+        loader.load(path, sources);
+        return sources.get(ShaderStage::Vertex).size() + sources.get(ShaderStage::Fragment).size();
+    });
+
+    run("warm", iterations, bytes, [&]() {
+        loader.load(path, sources);
+        return sources.get(ShaderStage::Vertex).size() + sources.get(ShaderStage::Fragment).size();
+    });
+
+    return 0;
+}
\ No newline at end of file
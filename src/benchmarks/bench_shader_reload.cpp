@@ -0,0 +1,210 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+#include "bench_common.hpp"
+
+#include "../advanced/opengl/errors.hpp"
+#include "../advanced/opengl/vertex_array.hpp"
+#include "../advanced/opengl/shader.hpp"
+#include "../advanced/opengl/shader_watcher.hpp"
+
+// Draws a watched shader while rewriting a file it includes, like
+// someone editing it, and reports the frame times and how long
+// `ShaderWatcher::update` took, which is all a reload costs the render
+// thread. Compares them with reloading synchronously (reading, parsing,
+// compiling, linking and drawing once in the frame). One version in the
+// middle doesn't compile, and the previous program must be kept.
+// llvmpipe generates the final code on the first draw with a program,
+// which shows up in the frame times however the program was made.
+
+static const char* MAIN_SHADER =
+    "#shader vertex\n"
+    "#version 330 core\n"
+    "layout(location = 0) in vec4 position;\n"
+    "void main()\n{\n"
+    "    gl_Position = position;\n"
+    "}\n\n"
+    "#shader fragment\n"
+    "#version 330 core\n"
+    "layout(location = 0) out vec4 color;\n"
+    "uniform vec4 u_Color;\n"
+    "#include \"tint.glsl\"\n"
+    "void main()\n{\n"
+    "    color = tint(u_Color);\n"
+    "}\n";
+
+// Mesa has its own on-disk shader cache, so every run and
+// version must have new sources to really be compiled.
+static void write_tint(const std::string& path, const std::string& salt,
+                       std::size_t version, bool broken)
+{
+    std::ofstream file(path, std::ios::trunc);
+
+    file << "// " << salt << "\n";
+    file << "vec4 tint(vec4 c)\n{\n";
+    file << "    float k = " << version << ".0 * 1e-9;\n";
+    for (std::size_t i = 0; i < 16; ++i) {
+        file << "    c = mix(c, sin(c * " << i + version << ".0), k);\n";
+    }
+    file << (broken ? "    return c\n" : "    return c;\n");
+    file << "}\n";
+}
+
+static double percentile(std::vector<double> times, double p)
+{
+    std::sort(times.begin(), times.end());
+    return times[(std::size_t)(p * (times.size() - 1))];
+}
+
+int main(int argc, char** argv)
+{
+    Context context(bench_context_settings(argc, argv));
+    if (!bench_init_context(context))
+        return 1;
+
+    double duration = argc > 1 ? std::atof(argv[1]) : 3.0;
+    double interval = argc > 2 ? std::atof(argv[2]) / 1000.0 : 0.25;
+    std::string directory = argc > 3 ? argv[3] : "build/shader_reload_bench";
+
+    gl_init_errors();
+
+    std::filesystem::create_directories(directory);
+    std::string shader_path = directory + "/shader.glsl";
+    std::string tint_path = directory + "/tint.glsl";
+    std::string salt = std::to_string((long long)(bench_now() * 1e6));
+
+    std::ofstream(shader_path, std::ios::trunc) << MAIN_SHADER;
+    write_tint(tint_path, salt, 0, false);
+
+    float vertexes[] = {
+        -0.5f, -0.5f,
+        +0.0f, +0.5f,
+        +0.5f, -0.5f,
+    };
+
+    VertexArray va;
+    va.bind();
+
+    VertexBuffer* vb = va.bind_vertex_buffer(vertexes, sizeof(vertexes));
+    vb->set_layout<VertexLayout<Attr<float, 2>>>();
+
+    va.unbind_all();
+
+    Shader shader(shader_path);
+    if (!shader.valid)
+        return 1;
+
+    UniformHandle u_color = shader.get_uniform("u_Color");
+    shader.watch();
+
+    /*                      *
+     *   Edit and reload    *
+     *                      */
+
+    std::vector<double> frame_times;
+    double max_update = 0;
+    std::size_t writes = 0;
+    std::size_t reloads = 0;
+    std::size_t broken_write = 3;
+    GLuint broken_program = 0;
+    bool kept_program = true;
+
+    GLuint program = shader.get_id();
+    double start = bench_now();
+    double next_write = start + interval;
+
+    while (bench_now() - start < duration) {
+        double now = bench_now();
+
+        // Out of the frame: the editor does this.
+        if (now >= next_write) {
+            ++writes;
+            write_tint(tint_path, salt, writes, writes == broken_write);
+            next_write = now + interval;
+
+            if (writes == broken_write)
+                broken_program = shader.get_id();
+        }
+
+        double frame_start = bench_now();
+
+        shader_watcher().update();
+        max_update = std::max(max_update, bench_now() - frame_start);
+
+        gl(Clear, GL_COLOR_BUFFER_BIT);
+
+        shader.bind();
+        shader.set_uniform_4f(u_color, 0.2f, 0.3f, 0.8f, 1.0f);
+
+        va.bind();
+        gl(DrawArrays, GL_TRIANGLES, 0, 3);
+
+        bench_swap_buffers();
+        // Headless swaps don't wait for anything.
+        glFinish();
+
+        frame_times.push_back(bench_now() - frame_start);
+
+        if (shader.get_id() != program) {
+            program = shader.get_id();
+            ++reloads;
+
+            // Only the next version may replace the broken one.
+            if (writes == broken_write)
+                kept_program = false;
+        }
+    }
+
+    // Wait for the last write, so nothing is left compiling.
+    double settle = bench_now();
+    while (bench_now() - settle < 0.5 || shader_watcher().get_reloading() > 0) {
+        shader_watcher().update();
+    }
+    glFinish();
+
+    /*                          *
+     *   Synchronous reloads    *
+     *                          */
+
+    std::size_t sync_count = 10;
+    double sync_start = bench_now();
+
+    for (std::size_t i = 0; i < sync_count; ++i) {
+        write_tint(tint_path, salt + "sync", i, false);
+
+        Shader reloaded(shader_path);
+        reloaded.bind();
+        reloaded.set_uniform_4f("u_Color", 0.2f, 0.3f, 0.8f, 1.0f);
+
+        va.bind();
+        gl(DrawArrays, GL_TRIANGLES, 0, 3);
+        glFinish();
+
+        shader_source_loader().clear_cache();
+    }
+
+    double sync_time = (bench_now() - sync_start) / sync_count;
+
+    std::cout << "frames:            " << frame_times.size() << std::endl;
+    std::cout << "writes:            " << writes << std::endl;
+    std::cout << "reloads:           " << reloads << std::endl;
+    std::cout << "broken version:    "
+              << (broken_program != 0 && kept_program ? "previous program kept" : "NOT KEPT")
+              << std::endl;
+    std::cout << "frame time:" << std::endl;
+    std::cout << "  median:          " << percentile(frame_times, 0.5) * 1000.0 << " ms"
+              << std::endl;
+    std::cout << "  99th percentile: " << percentile(frame_times, 0.99) * 1000.0 << " ms"
+              << std::endl;
+    std::cout << "  max:             " << percentile(frame_times, 1.0) * 1000.0 << " ms"
+              << std::endl;
+    std::cout << "max update:        " << max_update * 1000.0 << " ms" << std::endl;
+    std::cout << "synchronous reload: " << sync_time * 1000.0 << " ms" << std::endl;
+
+    return broken_program != 0 && kept_program ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include <iostream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+#include "bench_common.hpp"
+
+#include "../advanced/opengl/errors.hpp"
+#include "../advanced/opengl/shader.hpp"
+#include "../advanced/opengl/program_cache.hpp"
+
+// Creates many programs (variants of the same file with different
+// defines) and reports how long it takes:
+//  - no cache: compiling and linking from source;
+//  - cold:     same, plus storing the binaries in the program cache;
+//  - warm:     loading the binaries from the program cache.
+
+static double create_programs(std::size_t count, const std::string& salt)
+{
+    std::vector<Shader> shaders;
+    shaders.reserve(count);
+
+    double start = bench_now();
+
+    for (std::size_t i = 0; i < count; ++i) {
+        Shader& shader = shaders.emplace_back("resources/default_vertex_color.glsl",
+                                              std::vector<std::string> {
+                                                  "VARIANT " + std::to_string(i),
+                                                  "SALT " + salt });
+        if (!shader.valid) {
+            std::cerr << "ERROR: could not create program " << i << std::endl;
+        }
+    }
+
+    glFinish();
+
+    return bench_now() - start;
+}
+
+static void report(const char* label, std::size_t count, double elapsed)
+{
+    std::cout << label << ":" << std::endl;
+    std::cout << "  total:       " << elapsed * 1000.0 << " ms" << std::endl;
+    std::cout << "  per program: " << elapsed * 1000.0 / count << " ms" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    Context context(bench_context_settings(argc, argv));
+    if (!bench_init_context(context))
+        return 1;
+
+    std::size_t count = argc > 1 ? std::atol(argv[1]) : 50;
+    std::string directory = argc > 2 ? argv[2] : "build/program_cache_bench";
+
+    gl_init_errors();
+
+    // Mesa has its own on-disk shader cache (which it also needs to
+    // support program binaries), so every run uses new sources to
+    // keep it from making the cold runs warm.
+    std::string salt = std::to_string((long long)(bench_now() * 1e6));
+
+    report("no cache", count, create_programs(count, salt + "0"));
+
+    std::filesystem::remove_all(directory);
+
+    if (!gl_program_cache().enable(directory))
+        return 1;
+
+    report("cold", count, create_programs(count, salt + "1"));
+    report("warm", count, create_programs(count, salt + "1"));
+
+    return 0;
+}
\ No newline at end of file
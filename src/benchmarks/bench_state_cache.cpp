@@ -0,0 +1,93 @@
+#include <iostream>
+#include <cstdlib>
+
+#include "bench_common.hpp"
+
+#include "../advanced/opengl/errors.hpp"
+#include "../advanced/opengl/vertex_array.hpp"
+#include "../advanced/opengl/shader.hpp"
+#include "../advanced/opengl/state_cache.hpp"
+
+// Draws many objects sharing a shader and a vertex array, like the loop
+// in abstraction_test.cpp, and reports how many binds `GLStateCache` skips:
+//  - unbind:    binds and unbinds around every draw, like abstraction_sample.cpp;
+//  - no-unbind: binds before every draw and leaves things bound.
+
+static void run(const char* label, bool unbind, std::size_t frames, std::size_t objects,
+                VertexArray& va, Shader& shader)
+{
+    gl_state().reset_stats();
+
+    double start = bench_now();
+
+    for (std::size_t frame = 0; frame < frames; ++frame) {
+        gl(Clear, GL_COLOR_BUFFER_BIT);
+
+        for (std::size_t i = 0; i < objects; ++i) {
+            shader.bind();
+            va.bind();
+
+            va.draw_elements(3);
+
+            if (unbind) {
+                va.unbind();
+                shader.unbind();
+            }
+        }
+
+        gl_frame_check_errors();
+        bench_swap_buffers();
+    }
+
+    glFinish();
+
+    double elapsed = bench_now() - start;
+    const GLStateStats& stats = gl_state().get_stats();
+
+    std::cout << label << ":" << std::endl;
+    std::cout << "  ms/frame:       " << elapsed * 1000.0 / frames << std::endl;
+    std::cout << "  issued/frame:   " << stats.issued / frames << std::endl;
+    std::cout << "  skipped/frame:  " << stats.skipped / frames << std::endl;
+
+    if (!gl_state().validate()) {
+        std::cerr << "ERROR: state cache is out of sync" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Context context(bench_context_settings(argc, argv));
+    if (!bench_init_context(context))
+        return 1;
+
+    std::size_t frames = argc > 1 ? std::atol(argv[1]) : 100;
+    std::size_t objects = argc > 2 ? std::atol(argv[2]) : 10000;
+
+    gl_init_errors();
+
+    float vertexes[] = {
+        -0.01f, -0.01f,
+        +0.00f, +0.01f,
+        +0.01f, -0.01f,
+    };
+
+    unsigned int indices[] = {
+        0, 1, 2
+    };
+
+    VertexArray va;
+    va.bind();
+
+    VertexBuffer* vb = va.bind_vertex_buffer(vertexes, sizeof(vertexes));
+    vb->set_attribute_layout(0, 2, GL_FLOAT, GL_FALSE, sizeof(vertexes[0]) * 2, 0);
+    va.bind_index_buffer(indices, 3);
+
+    va.unbind_all();
+
+    Shader shader("resources/default_fragment_color.glsl");
+
+    run("unbind", true, frames, objects, va, shader);
+    run("no-unbind", false, frames, objects, va, shader);
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include <iostream>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+
+#include "bench_common.hpp"
+
+#include "../advanced/opengl/errors.hpp"
+#include "../advanced/opengl/vertex_array.hpp"
+#include "../advanced/opengl/shader.hpp"
+
+// Measures how fast vertices can be uploaded and drawn every frame:
+//  - persistent: `StreamingVertexBuffer` with a persistent mapping;
+//  - map-range:  `StreamingVertexBuffer` with unsynchronized mapping;
+//  - subdata:    orphaning a regular buffer with `glBufferData`
+//                and filling it with `glBufferSubData`.
+
+struct Vertex {
+    float x, y;
+    float r, g, b, a;
+};
+
+using Layout = VertexLayout<Attr<float, 2>, Attr<float, 4>>;
+VERTEX_LAYOUT_CHECK(Layout, Vertex, x, r);
+
+static void fill_vertices(Vertex* vertices, std::size_t count, std::size_t frame)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        // Degenerate triangles, so rasterization doesn't dominate.
+        std::size_t triangle = i / 3;
+        float x = (float)((triangle * 7 + frame) % 1000) / 500.0f - 1.0f;
+        float y = (float)((triangle * 13) % 1000) / 500.0f - 1.0f;
+        vertices[i] = { x, y, 1.0f, 0.5f, 0.2f, 1.0f };
+    }
+}
+
+static void report(const char* label, std::size_t frames, std::size_t bytes_per_frame,
+                   double elapsed)
+{
+    double megabytes = (double)(bytes_per_frame * frames) / (1024.0 * 1024.0);
+
+    std::cout << label << ":" << std::endl;
+    std::cout << "  MB/frame:  " << (double)bytes_per_frame / (1024.0 * 1024.0) << std::endl;
+    std::cout << "  ms/frame:  " << elapsed * 1000.0 / frames << std::endl;
+    std::cout << "  MB/second: " << megabytes / elapsed << std::endl;
+}
+
+static bool run_streaming(const char* label, bool persistent, 
+                          std::size_t frames, std::size_t vertex_count)
+{
+    std::size_t bytes_per_frame = vertex_count * sizeof(Vertex);
+
+    VertexArray va;
+    va.bind();
+
+    StreamingVertexBuffer svb(bytes_per_frame + sizeof(Vertex), 3, persistent);
+    svb.bind();
+    svb.set_layout<Layout>();
+
+    double start = bench_now();
+
+    for (std::size_t frame = 0; frame < frames; ++frame) {
+        gl(Clear, GL_COLOR_BUFFER_BIT);
+
+        svb.begin_frame();
+
+        std::size_t offset;
+        Vertex* vertices = (Vertex*)svb.map(bytes_per_frame, sizeof(Vertex), offset);
+        if (!vertices) {
+            std::cerr << "ERROR: " << label << ": could not map the buffer" << std::endl;
+            va.unbind_all();
+            return false;
+        }
+
+        fill_vertices(vertices, vertex_count, frame);
+        svb.unmap();
+
+        gl(DrawArrays, GL_TRIANGLES, offset / sizeof(Vertex), vertex_count);
+
+        svb.end_frame();
+
+        gl_frame_check_errors();
+        bench_swap_buffers();
+    }
+
+    glFinish();
+
+    report(label, frames, bytes_per_frame, bench_now() - start);
+    std::cout << "  stalls:    " << svb.get_stall_count() << std::endl;
+
+    va.unbind_all();
+
+    return true;
+}
+
+static void run_subdata(const char* label, std::size_t frames, std::size_t vertex_count)
+{
+    std::size_t bytes_per_frame = vertex_count * sizeof(Vertex);
+    std::vector<Vertex> vertices(vertex_count);
+
+    VertexArray va;
+    va.bind();
+
+    VertexBuffer* vb = va.bind_vertex_buffer(nullptr, bytes_per_frame);
+    vb->set_layout<Layout>();
+
+    double start = bench_now();
+
+    for (std::size_t frame = 0; frame < frames; ++frame) {
+        gl(Clear, GL_COLOR_BUFFER_BIT);
+
+        fill_vertices(vertices.data(), vertex_count, frame);
+
+        gl(BufferData, GL_ARRAY_BUFFER, bytes_per_frame, nullptr, GL_STREAM_DRAW);
+        gl(BufferSubData, GL_ARRAY_BUFFER, 0, bytes_per_frame, vertices.data());
+
+        gl(DrawArrays, GL_TRIANGLES, 0, vertex_count);
+
+        gl_frame_check_errors();
+        bench_swap_buffers();
+    }
+
+    glFinish();
+
+    report(label, frames, bytes_per_frame, bench_now() - start);
+
+    va.unbind_all();
+}
+
+int main(int argc, char** argv)
+{
+    Context context(bench_context_settings(argc, argv));
+    if (!bench_init_context(context))
+        return 1;
+
+    std::size_t frames = argc > 1 ? std::atol(argv[1]) : 300;
+    std::size_t vertex_count = argc > 2 ? std::atol(argv[2]) : 300000;
+
+    gl_init_errors();
+
+    Shader shader("resources/default_vertex_color.glsl");
+    if (!shader.valid)
+        return 1;
+
+    shader.bind();
+
+    if (!run_streaming("persistent", true, frames, vertex_count) ||
+        !run_streaming("map-range", false, frames, vertex_count))
+        return 1;
+
+    run_subdata("subdata", frames, vertex_count);
+
+    shader.unbind();
+
+    return 0;
+}
\ No newline at end of file
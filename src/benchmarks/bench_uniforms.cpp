@@ -0,0 +1,125 @@
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <cstdlib>
+
+#include "bench_common.hpp"
+
+#include "../advanced/opengl/errors.hpp"
+#include "../advanced/opengl/shader.hpp"
+
+// Compares three ways of setting a uniform 10k times per frame:
+//  - legacy: what `Shader::set_uniform_4f` used to do (temporary
+//            `std::string`, two hash map lookups);
+//  - name:   `Shader::set_uniform_4f` with a string literal;
+//  - handle: `Shader::set_uniform_4f` with a `UniformHandle`.
+
+static std::unordered_map<std::string, int> legacy_locations;
+
+static int legacy_get_uniform_location(GLuint program, const std::string& name)
+{
+    if (legacy_locations.find(name) != legacy_locations.end()) {
+        return legacy_locations[name];
+    }
+
+    int loc = glGetUniformLocation(program, name.c_str());
+    legacy_locations[name] = loc;
+
+    return loc;
+}
+
+static void legacy_set_uniform_4f(GLuint program, const std::string& name,
+                                  float x, float y, float z, float w)
+{
+    glUniform4f(legacy_get_uniform_location(program, name), x, y, z, w);
+}
+
+// Elements past the first one aren't listed as active uniforms, they
+// have to be found by name too.
+static bool check_array_elements()
+{
+    Shader shader("resources/array_color.glsl");
+    if (!shader.valid)
+        return false;
+
+    shader.bind();
+    shader.set_uniform_4f("u_Colors[2]", 0.25f, 0.5f, 0.75f, 1.0f);
+
+    GLint program;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+
+    float value[4] = {};
+    glGetUniformfv(program, glGetUniformLocation(program, "u_Colors[2]"), value);
+
+    shader.unbind();
+
+    if (value[0] != 0.25f || value[3] != 1.0f) {
+        std::cerr << "ERROR: `u_Colors[2]` wasn't set" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+template <typename F>
+static void run(const char* label, std::size_t frames, F&& set_uniforms)
+{
+    const std::size_t sets_per_frame = 10000;
+
+    double start = bench_now();
+
+    for (std::size_t frame = 0; frame < frames; ++frame) {
+        for (std::size_t i = 0; i < sets_per_frame; ++i) {
+            set_uniforms((float)(i & 1));
+        }
+        glFlush();
+    }
+
+    glFinish();
+
+    double elapsed = bench_now() - start;
+
+    std::cout << label << ":" << std::endl;
+    std::cout << "  ms/frame:   " << elapsed * 1000.0 / frames << std::endl;
+    std::cout << "  ns/set:     " << elapsed * 1e9 / (frames * sets_per_frame) << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    Context context(bench_context_settings(argc, argv));
+    if (!bench_init_context(context))
+        return 1;
+
+    std::size_t frames = argc > 1 ? std::atol(argv[1]) : 200;
+
+    gl_init_errors();
+
+    if (!check_array_elements())
+        return 1;
+
+    Shader shader("resources/default_fragment_color.glsl");
+    if (!shader.valid)
+        return 1;
+
+    shader.bind();
+
+    GLint program;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+
+    run("legacy", frames, [&](float r) {
+        legacy_set_uniform_4f(program, "u_Color", r, 0.3f, 0.8f, 1.0f);
+    });
+
+    run("name", frames, [&](float r) {
+        shader.set_uniform_4f("u_Color", r, 0.3f, 0.8f, 1.0f);
+    });
+
+    UniformHandle u_color = shader.get_uniform("u_Color");
+    run("handle", frames, [&](float r) {
+        shader.set_uniform_4f(u_color, r, 0.3f, 0.8f, 1.0f);
+    });
+
+    shader.unbind();
+
+    return 0;
+}
\ No newline at end of file
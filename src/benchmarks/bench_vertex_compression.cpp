@@ -0,0 +1,126 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+#include "bench_common.hpp"
+
+#include "../advanced/opengl/errors.hpp"
+#include "../advanced/opengl/vertex_array.hpp"
+#include "../advanced/opengl/vertex_encoding.hpp"
+#include "../advanced/opengl/shader.hpp"
+
+// Draws the same colored 2D mesh with its vertices encoded as:
+//  - float:          float positions and colors (24 bytes);
+//  - half+unorm8:    half float positions, byte colors (8 bytes);
+//  - snorm16+unorm8: quantized positions, byte colors (8 bytes);
+//  - half+unorm1010102: half float positions, 10/10/10/2 colors (8 bytes).
+
+struct Vertex {
+    float x, y;
+    float r, g, b, a;
+};
+
+// Small triangles all over the screen, so vertex fetch
+// matters more than rasterization.
+static std::vector<Vertex> make_mesh(std::size_t triangle_count)
+{
+    std::vector<Vertex> vertices;
+    vertices.reserve(triangle_count * 3);
+
+    const float size = 0.002f;
+
+    for (std::size_t i = 0; i < triangle_count; ++i) {
+        float x = (float)(i % 997) / 498.5f - 1.0f;
+        float y = (float)(i / 997 % 991) / 495.5f - 1.0f;
+        float r = (float)(i % 255) / 255.0f;
+        float g = (float)(i % 7) / 7.0f;
+
+        vertices.push_back({ x, y, r, g, 0.8f, 1.0f });
+        vertices.push_back({ x + size, y, r, g, 0.8f, 1.0f });
+        vertices.push_back({ x, y + size, r, g, 0.8f, 1.0f });
+    }
+
+    return vertices;
+}
+
+static void run(const char* label, const std::vector<Vertex>& mesh,
+                VertexEncoding position_encoding, VertexEncoding color_encoding,
+                std::size_t frames)
+{
+    std::vector<VertexStream> streams = {
+        { &mesh[0].x, 2, position_encoding, sizeof(Vertex) / sizeof(float) },
+        { &mesh[0].r, 4, color_encoding, sizeof(Vertex) / sizeof(float) },
+    };
+
+    double encode_start = bench_now();
+    EncodedVertices encoded = encode_vertices(streams, mesh.size());
+    double encode_time = bench_now() - encode_start;
+
+    bool quantized = position_encoding == VertexEncoding::Snorm16;
+    Shader shader(quantized ? "resources/quantized_vertex_color.glsl"
+                                          : "resources/default_vertex_color.glsl");
+
+    shader.bind();
+    if (quantized) {
+        const EncodedAttribute& position = encoded.attributes[0];
+        shader.set_uniform_2f("u_PositionScale", position.scale[0], position.scale[1]);
+        shader.set_uniform_2f("u_PositionOffset", position.offset[0], position.offset[1]);
+    }
+
+    VertexArray va;
+    va.bind();
+
+    double upload_start = bench_now();
+    va.bind_vertex_buffer(encoded.data.data(), encoded.data.size());
+    encoded.apply();
+    glFinish();
+    double upload_time = bench_now() - upload_start;
+
+    double start = bench_now();
+
+    for (std::size_t frame = 0; frame < frames; ++frame) {
+        gl(Clear, GL_COLOR_BUFFER_BIT);
+        gl(DrawArrays, GL_TRIANGLES, 0, encoded.vertex_count);
+
+        gl_frame_check_errors();
+        bench_swap_buffers();
+    }
+
+    glFinish();
+
+    double elapsed = bench_now() - start;
+
+    std::cout << label << ":" << std::endl;
+    encoded.report();
+    std::cout << "  bytes/vertex:  " << encoded.stride << std::endl;
+    std::cout << "  encode MB/s:   " << encoded.source_size / encode_time / 1e6 << std::endl;
+    std::cout << "  upload ms:     " << upload_time * 1000.0 << std::endl;
+    std::cout << "  ms/frame:      " << elapsed * 1000.0 / frames << std::endl;
+
+    va.unbind();
+    shader.unbind();
+}
+
+int main(int argc, char** argv)
+{
+    Context context(bench_context_settings(argc, argv));
+    if (!bench_init_context(context))
+        return 1;
+
+    std::size_t frames = argc > 1 ? std::atol(argv[1]) : 20;
+    std::size_t triangle_count = argc > 2 ? std::atol(argv[2]) : 1000000;
+
+    gl_init_errors();
+
+    std::cout << "INFO: SIMD conversion: " << (vertex_encoding_simd() ? "yes" : "no") 
+              << std::endl;
+
+    std::vector<Vertex> mesh = make_mesh(triangle_count);
+
+    run("float", mesh, VertexEncoding::Float, VertexEncoding::Float, frames);
+    run("half+unorm8", mesh, VertexEncoding::Half, VertexEncoding::Unorm8, frames);
+    run("snorm16+unorm8", mesh, VertexEncoding::Snorm16, VertexEncoding::Unorm8, frames);
+    run("half+unorm1010102", mesh, VertexEncoding::Half, VertexEncoding::Unorm2101010, frames);
+
+    return 0;
+}
\ No newline at end of file
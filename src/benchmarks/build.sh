@@ -0,0 +1,32 @@
+# This file is meant to be run with the `subdir` command
+# of the project's root folder's ./build.sh.
+
+# Built by `src/advanced/build.sh`.
+OPENGL_LIB=$(library_path opengl)
+
+# The error policy changes the `gl()` macro everywhere,
+# so every policy needs its own build of the library.
+for policy in full frame debug off; do
+    POLICY_FLAG="-DGL_ERROR_POLICY=GL_ERRORS_$(echo $policy | tr a-z A-Z)"
+    library opengl_$policy "$POLICY_FLAG" ../advanced/opengl/*.cpp
+    build_variant bench_error_policy_$policy "$POLICY_FLAG" \
+                  bench_error_policy.cpp $(library_path opengl_$policy)
+done
+
+build bench_uniforms.cpp $OPENGL_LIB
+build bench_streaming.cpp $OPENGL_LIB
+build bench_batching.cpp $OPENGL_LIB
+build bench_instancing.cpp $OPENGL_LIB
+build bench_state_cache.cpp $OPENGL_LIB
+build bench_shader_startup.cpp $OPENGL_LIB
+build bench_parallel_compile.cpp $OPENGL_LIB
+build bench_shader_parse.cpp $OPENGL_LIB
+build bench_vertex_compression.cpp $OPENGL_LIB
+build bench_index_optimization.cpp $OPENGL_LIB
+build bench_mesh_loading.cpp $OPENGL_LIB
+build bench_object_lifetime.cpp $OPENGL_LIB
+build bench_shader_reload.cpp $OPENGL_LIB
+build bench_render_thread.cpp $OPENGL_LIB
+build bench_draw_sorting.cpp $OPENGL_LIB
+build bench_frame_allocations.cpp $OPENGL_LIB
+build bench_indirect_draw.cpp $OPENGL_LIB
\ No newline at end of file
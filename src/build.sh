@@ -2,4 +2,5 @@
 # of the project's root folder's ./build.sh.
 
 subdir advanced
-subdir basic
\ No newline at end of file
+subdir basic
+subdir benchmarks
\ No newline at end of file
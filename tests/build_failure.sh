@@ -0,0 +1,68 @@
+#!/bin/bash
+
+set -e
+
+# Checks that ./build.sh fails, and doesn't keep the old objects, when
+# a source doesn't compile or an executable doesn't link. Works on a
+# copy of the tree, and needs what ./build.sh needs.
+#
+# Usage: ./tests/build_failure.sh
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# The tracked files as they are now, without any build.
+(cd "$ROOT" && git ls-files -z | xargs -0 cp --parents -t "$WORK")
+cd "$WORK"
+
+function fail() {
+    echo "FAIL: $1" >&2
+    exit 1
+}
+
+function expect_failure() {
+    if ./build.sh > build.log 2>&1; then
+        fail "$1: ./build.sh succeeded"
+    fi
+
+    echo "OK: $1"
+}
+
+function break_file() {
+    cp "$1" "$1.orig"
+    echo "$2" >> "$1"
+}
+
+function restore_file() {
+    mv "$1.orig" "$1"
+    # Like an edit, so it's newer than anything built from the broken one.
+    touch "$1"
+}
+
+if ! ./build.sh > build.log 2>&1; then
+    cat build.log >&2
+    fail "the tree doesn't build to begin with"
+fi
+
+LIBRARY_SOURCE=src/advanced/opengl/errors.cpp
+EXECUTABLE_SOURCE=src/benchmarks/bench_batching.cpp
+
+break_file $LIBRARY_SOURCE "this is not C++"
+expect_failure "broken library source"
+[ ! -f build/debug/obj/libopengl/errors.o ] || fail "the old library object was kept"
+restore_file $LIBRARY_SOURCE
+
+break_file $EXECUTABLE_SOURCE "this is not C++"
+expect_failure "broken executable source"
+restore_file $EXECUTABLE_SOURCE
+
+break_file $EXECUTABLE_SOURCE "void missing_function(); static int force = (missing_function(), 0);"
+expect_failure "broken link"
+restore_file $EXECUTABLE_SOURCE
+
+if ! ./build.sh > build.log 2>&1; then
+    cat build.log >&2
+    fail "the tree doesn't build once fixed"
+fi
+echo "OK: fixed again"
\ No newline at end of file